@@ -0,0 +1,29 @@
+#include <iostream>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ *
+ * The written log file can be read using the decompress tool, e.g:
+ *
+ * $ tool/decompress compress.log.lgz
+ */
+
+#include "logg/compress.h"
+#include "logg/logg.h"
+
+int main() {
+  logg::compress_buf buf;
+  if (!buf.open("compress.log.lgz", 64 * 1024)) {
+    std::cerr << "Failed to open compress.log.lgz" << std::endl;
+    return 1;
+  }
+
+  std::ostream log(&buf);
+
+  for (auto i = 0; i < 10000; i++) {
+    logg::info(log) << "Hello, world! i=" << i;
+  }
+}
@@ -0,0 +1,24 @@
+#include <iostream>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ */
+
+#include "logg/logg.h"
+
+void handle_request(int id) {
+  logg::context req("req", id);
+  logg::info(std::cout) << "Handling request";
+}
+
+int main() {
+  logg::context tenant("tenant", "acme");
+
+  handle_request(17);
+  handle_request(42);
+
+  logg::info(std::cout) << "Done";
+}
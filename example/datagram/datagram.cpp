@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "logg/datagram.h"
+#include "logg/logg.h"
+
+namespace {
+  // Local agent stand-in, receives datagrams on a Unix socket.
+  struct agent {
+    agent() {
+      char dir[] = "/tmp/logg-XXXXXX";
+      if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        std::exit(1);
+      }
+
+      addr.sun_family = AF_UNIX;
+      std::snprintf(addr.sun_path, sizeof (addr.sun_path), "%s/agent", dir);
+
+      fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+      if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr),
+          sizeof (addr)) != 0) {
+        std::perror(addr.sun_path);
+        std::exit(1);
+      }
+    }
+
+    ~agent() {
+      close(fd);
+      unlink(addr.sun_path);
+      rmdir(std::string(addr.sun_path, std::strrchr(addr.sun_path, '/'))
+        .c_str());
+    }
+
+    // Prints received datagrams, returns the number printed.
+    int receive() {
+      char buf[2048];
+      auto received = 0;
+
+      for (;;) {
+        auto n = recv(fd, buf, sizeof (buf), MSG_DONTWAIT);
+        if (n < 0) {
+          return received;
+        }
+        std::cout.write(buf, n) << std::endl;
+        received++;
+      }
+    }
+
+    int fd = -1;
+    sockaddr_un addr{};
+  };
+}
+
+int main() {
+  agent a;
+
+  logg::datagram_buf buf;
+  if (!buf.open(a.addr.sun_path, "example", 1, 4)) {
+    std::cerr << "Failed to connect to agent" << std::endl;
+    return 1;
+  }
+
+  std::ostream log(&buf);
+
+  // Sent in batches of four log messages.
+  logg::error(log) << "Hello, world!";
+  logg::warn(log)  << "Hello, world!";
+  logg::info(log)  << "Hello, world!";
+  logg::debug(log) << "Hello, world!";
+  a.receive();
+
+  // A slow agent never blocks the caller, log messages are dropped once
+  // the queue is full.
+  for (auto i = 0; i < 10000; i++) {
+    logg::trace(log) << "i=" << i;
+  }
+
+  buf.close();
+
+  auto received = a.receive();
+  std::cout << "received=" << received << ", dropped=" << buf.dropped()
+    << std::endl;
+}
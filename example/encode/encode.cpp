@@ -0,0 +1,26 @@
+#include <iostream>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ */
+
+#include "logg/encode.h"
+#include "logg/logg.h"
+
+int main() {
+  unsigned char packet[100];
+  for (auto i = 0u; i < sizeof (packet); i++) {
+    packet[i] = static_cast<unsigned char>(i * 7);
+  }
+
+  // Binary payloads as hexadecimal and base64.
+  logg::trace(std::cout) << "packet=" << logg::hexdump(packet, 16);
+  logg::trace(std::cout) << "packet=" << logg::base64(packet, 16);
+
+  // Payloads longer than the limit are truncated.
+  logg::trace(std::cout) << "packet=" << logg::hexdump(packet,
+    sizeof (packet), 8);
+}
@@ -0,0 +1,23 @@
+#include <iostream>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ */
+
+#include "logg/logg.h"
+
+int main() {
+  // Format string checked at compile time against the argument types.
+  logg::info(std::cout).fmt("id={} t={:.3f}", 42, 3.14159);
+  logg::info(std::cout).fmt("flags={:x}", 255);
+
+  // Formatting state never leaks into the log stream.
+  logg::debug(std::cout).fmt("mask={:X} name={} ok={}", 0xbeefu, "foo", true);
+  logg::debug(std::cout) << 255;
+
+  // Mixing format strings and stream operators.
+  logg::trace(std::cout, lgsrc).fmt("{{escaped}} {:e}", 1e-9) << " done";
+}
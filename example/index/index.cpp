@@ -0,0 +1,32 @@
+#include <iostream>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ *
+ * Time ranges can be extracted from the written log file using the extract
+ * tool, e.g:
+ *
+ * $ tool/extract -l INFO index.log "2018-04-16 12:58"
+ */
+
+#include "logg/index.h"
+#include "logg/logg.h"
+
+int main() {
+  // Log file with an index entry at least every 4 KB.
+  logg::index_filebuf buf;
+  if (!buf.open("index.log", 4 * 1024)) {
+    std::cerr << "Failed to open index.log" << std::endl;
+    return 1;
+  }
+
+  std::ostream log(&buf);
+
+  for (auto i = 0; i < 1000; i++) {
+    logg::info(log)  << "Hello, world! i=" << i;
+    logg::debug(log) << "Hello, world! i=" << i;
+  }
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ */
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "logg/logg.h"
+#include "logg/shm.h"
+
+namespace {
+  const char name[] = "/logg-example";
+}
+
+int main() {
+  // The collector creates the ring, normally in a separate process.
+  logg::shm_collector collector;
+  if (!collector.open(name, 1024)) {
+    std::cerr << "Failed to create shared memory ring" << std::endl;
+    return 1;
+  }
+
+  // Worker processes log to the ring.
+  for (auto worker = 0; worker < 4; worker++) {
+    if (fork() == 0) {
+      logg::shm_buf buf;
+      buf.open(name);
+
+      std::ostream log(&buf);
+      for (auto i = 0; i < 5; i++) {
+        logg::info(log) << "Hello from worker " << worker << ", i=" << i;
+      }
+
+      _exit(0);
+    }
+  }
+
+  while (wait(nullptr) > 0) {}
+
+  collector.drain(std::cout);
+  shm_unlink(name);
+}
@@ -0,0 +1,39 @@
+#include <csignal>
+
+/*
+ * To change the global log level pass LOGG_LOG_LEVEL with your desired log
+ * level to cmake, e.g:
+ *
+ * $ cmake -DLOGG_LOG_LEVEL=logg::INFO ..
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "logg/signal.h"
+
+namespace {
+  // Must be created before any signal is handled.
+  const logg::signal_safe log(STDERR_FILENO);
+
+  void handler(int sig) {
+    logg::fatal(log, lgfun) << "Caught signal " << sig;
+  }
+}
+
+int main() {
+  std::signal(SIGUSR1, handler);
+  std::raise(SIGUSR1);
+
+  // Logging in a child between fork and exec.
+  auto pid = fork();
+  if (pid == 0) {
+    logg::info(log, lgsrc) << "Child " << getpid() << " about to exec";
+    execlp("true", "true", nullptr);
+    logg::error(log) << "exec failed, errno=" << errno;
+    _exit(1);
+  }
+
+  waitpid(pid, nullptr, 0);
+  logg::log<42>(log) << "Done, ok=" << true << ", p=" << &pid;
+}
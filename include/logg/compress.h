@@ -0,0 +1,164 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include "levels.h"
+
+namespace logg::detail {
+  // Compression codecs of a block.
+  enum codec : std::uint32_t {
+    STORED = 0,
+    LZ4    = 1,
+    ZSTD   = 2
+  };
+
+  // Header preceding each compressed block in a log file.
+  struct block_header {
+    std::uint32_t magic;
+    std::uint32_t codec;
+    std::uint32_t raw_size;
+    std::uint32_t size;
+  };
+
+  // Magic identifying a block header, "LGZB".
+  constexpr const std::uint32_t block_magic = 0x425a474c;
+
+  // Largest raw block size accepted when decoding.
+  constexpr const std::uint32_t max_block_size = 64 * 1024 * 1024;
+
+  // Worst case size of a LZ4 compressed block.
+  constexpr std::size_t lz4_bound(std::size_t size) noexcept {
+    return size + size / 255 + 16;
+  }
+
+  // Compresses a block using the LZ4 block format. The destination must hold
+  // at least lz4_bound(size) bytes. Returns the compressed size.
+  std::size_t lz4_compress(const char* src, std::size_t size, char* dst)
+    noexcept;
+
+  // Decompresses a LZ4 block of exactly raw_size bytes. Returns false if the
+  // block is corrupt.
+  bool lz4_decompress(const char* src, std::size_t size, char* dst,
+    std::size_t raw_size) noexcept;
+
+  // Compresses a block, using zstd when available and LZ4 otherwise, and
+  // writes the block header followed by the compressed data to out.
+  void encode_block(const char* src, std::size_t size, std::vector<char>& out);
+
+  // Decompresses the data following a block header. The destination must
+  // hold header.raw_size bytes. Returns false if the block is corrupt or
+  // its codec unsupported.
+  bool decode_block(const block_header& header, const char* src, char* dst)
+    noexcept;
+}
+
+namespace logg {
+  /**
+   * Stream buffer writing compressed log messages to a file.
+   *
+   * Log messages are collected in memory, exactly like a buffered file
+   * stream, and handed over to a background thread when a block has been
+   * filled. The background thread compresses the block and appends it to
+   * the file. Each block is preceded by a header and can be decompressed
+   * independently of the other blocks, making it possible to append to an
+   * existing file. Use the decompress tool to read the file.
+   *
+   * Blocks preferably end on a log message boundary. A partially filled
+   * block is handed over early when a log message of @p flush_level or
+   * more severe is completed, and written before returning, so that e.g. a
+   * FATAL log message preceding a crash reaches the file. A partially
+   * filled block is also handed over once its oldest log message is @p
+   * max_age old, checked whenever a log message is completed. Other log
+   * messages still in memory when the process dies are lost, close the
+   * buffer to make sure everything has been written.
+   */
+  class compress_buf : public std::streambuf {
+  public:
+    compress_buf() = default;
+    ~compress_buf() override;
+
+    compress_buf(const compress_buf&) = delete;
+    compress_buf& operator=(const compress_buf&) = delete;
+
+    /**
+     * Opens the file for appending and starts the background thread.
+     *
+     * @param path File path.
+     * @param block_size Uncompressed block size.
+     * @param flush_level Log level written immediately, OFF to disable.
+     * @param max_age Longest time a log message is held in memory, zero to
+     *   disable.
+     * @return This buffer on success, otherwise nullptr.
+     */
+    compress_buf* open(const char* path, std::size_t block_size = 256 * 1024,
+      unsigned flush_level = ERROR,
+      std::chrono::milliseconds max_age = std::chrono::seconds(1));
+
+    /**
+     * Compresses and writes any remaining log messages, stops the
+     * background thread and closes the file.
+     *
+     * @return This buffer on success, otherwise nullptr.
+     */
+    compress_buf* close();
+
+  protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+  private:
+    // Hands the current block over to the background thread, except the
+    // last @p keep bytes which start the next block. Returns the sequence
+    // number of the block.
+    std::uint64_t submit(std::size_t keep = 0);
+
+    // Background thread compressing and writing blocks.
+    void run();
+
+    // Compressed log file.
+    std::FILE* file = nullptr;
+
+    // Uncompressed block size.
+    std::size_t block_size = 0;
+
+    // Flush policy.
+    unsigned flush_level = OFF;
+    std::chrono::milliseconds max_age{0};
+
+    // Block currently being filled, the start of the log message being
+    // written, and the time the first log message was completed.
+    std::vector<char> block;
+    char* record = nullptr;
+    std::chrono::steady_clock::time_point since{};
+
+    // Level of the log message being written, if it spans blocks.
+    unsigned spanned = OFF;
+
+    // Number of blocks handed over, and written by the background thread.
+    std::uint64_t submitted = 0;
+    std::uint64_t written = 0;
+
+    // Blocks waiting to be compressed, and blocks ready to be reused.
+    std::deque<std::vector<char>> pending;
+    std::vector<std::vector<char>> pool;
+
+    // Set when the background thread should stop, once pending is empty.
+    bool done = false;
+
+    // Set if the background thread failed to write a block.
+    bool failed = false;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread worker;
+  };
+}
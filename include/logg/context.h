@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace logg::detail {
+  // Diagnostic context of a thread, pre-rendered as " key=value" pairs.
+  struct context_prefix {
+    char buf[128];
+    unsigned size;
+  };
+
+  // Diagnostic context of the current thread.
+  inline thread_local context_prefix thread_context{};
+
+  // Copies the diagnostic context of the current thread to the specified
+  // buffer. Returns the number of characters copied.
+  inline unsigned write_context(char* buf, unsigned size) noexcept {
+    auto n = thread_context.size < size ? thread_context.size : size;
+    std::memcpy(buf, thread_context.buf, n);
+    return n;
+  }
+}
+
+namespace logg {
+  /**
+   * Scoped diagnostic context.
+   *
+   * Pushes a key/value pair onto the diagnostic context of the current
+   * thread. The pair is rendered once, when the context is created, and
+   * copied into the header of every log message written by the thread until
+   * the context goes out of scope. Pairs not fitting in the remaining space
+   * of the thread's diagnostic context are dropped.
+   *
+   * Keys and values should not contain spaces, as this would make the log
+   * message header ambiguous.
+   */
+  class context {
+  public:
+    /**
+     * Pushes a key with a string value.
+     *
+     * @param key Key.
+     * @param value Value.
+     */
+    context(std::string_view key, std::string_view value) noexcept
+        : prev(detail::thread_context.size) {
+      auto& ctx = detail::thread_context;
+      auto size = 2 + key.size() + value.size();
+
+      if (size <= sizeof (ctx.buf) - prev) {
+        auto p = ctx.buf + prev;
+        *p++ = ' ';
+        p = std::copy(key.begin(), key.end(), p);
+        *p++ = '=';
+        std::copy(value.begin(), value.end(), p);
+        ctx.size += size;
+      }
+    }
+
+    /**
+     * Pushes a key with a string value.
+     *
+     * @param key Key.
+     * @param value Null terminated value.
+     */
+    context(std::string_view key, const char* value) noexcept
+        : context(key, std::string_view(value)) {}
+
+    /**
+     * Pushes a key with a boolean value.
+     *
+     * @param key Key.
+     * @param value Value.
+     */
+    context(std::string_view key, bool value) noexcept
+        : context(key, std::string_view(value ? "true" : "false")) {}
+
+    /**
+     * Pushes a key with a numeric value.
+     *
+     * @tparam Value Arithmetic type.
+     *
+     * @param key Key.
+     * @param value Value.
+     */
+    template<class Value,
+      class = std::enable_if_t<std::is_arithmetic_v<Value>>>
+    context(std::string_view key, Value value) noexcept
+        : context(key, std::string_view()) {
+      auto& ctx = detail::thread_context;
+
+      // Key and separator pushed, unless dropped, now append the value.
+      if (ctx.size != prev) {
+        auto r = std::to_chars(ctx.buf + ctx.size, ctx.buf + sizeof (ctx.buf),
+          value);
+        ctx.size = r.ec == std::errc() ? r.ptr - ctx.buf : prev;
+      }
+    }
+
+    /**
+     * Pops the key/value pair.
+     */
+    ~context() {
+      detail::thread_context.size = prev;
+    }
+
+    context(const context&) = delete;
+    context& operator=(const context&) = delete;
+
+  private:
+    // Size of the diagnostic context before the key/value pair was pushed.
+    unsigned prev;
+  };
+}
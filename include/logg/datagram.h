@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "levels.h"
+
+namespace logg::detail {
+  // Room reserved in front of each log message for the RFC 5424 header.
+  constexpr const std::size_t datagram_prefix_size = 256;
+
+  // Size of a slot holding a queued log message, including the header.
+  constexpr const std::size_t datagram_slot_size = 2048;
+
+  // Maps a log level to a syslog severity.
+  constexpr unsigned severity(unsigned level) noexcept {
+    return level == OFF ? 6  // Not a log message header, informational.
+      : level <= FATAL ? 2   // Critical.
+      : level <= ERROR ? 3   // Error.
+      : level <= WARN ? 4    // Warning.
+      : level <= INFO ? 6    // Informational.
+      : 7;                   // Debug.
+  }
+}
+
+namespace logg {
+  /**
+   * Stream buffer sending log messages to a local agent, e.g. syslog or
+   * journald, over a Unix datagram socket.
+   *
+   * Each log message is framed according to RFC 5424, with the severity
+   * mapped from its log level, and queued when completed. Queued log
+   * messages are sent in batches using sendmmsg(2), once a batch has been
+   * filled or the oldest queued log message has waited too long. Sending
+   * never blocks. When the agent falls behind, log messages stay queued
+   * and new log messages are dropped once the queue is full. When the
+   * agent has been restarted the socket is reconnected, at most once a
+   * second, and log messages failing to be sent meanwhile are dropped.
+   *
+   * Log messages are only sent while logging or when calling send(), a
+   * stream going quiet keeps its last batch queued until then. Close the
+   * buffer to send any remaining log messages.
+   */
+  class datagram_buf : public std::streambuf {
+  public:
+    datagram_buf() = default;
+    ~datagram_buf() override;
+
+    datagram_buf(const datagram_buf&) = delete;
+    datagram_buf& operator=(const datagram_buf&) = delete;
+
+    /**
+     * Connects to the agent.
+     *
+     * @param path Socket path, e.g. "/dev/log".
+     * @param app_name Application name.
+     * @param facility Syslog facility 0-23, default user-level.
+     * @param batch Number of log messages sent per batch.
+     * @param capacity Maximum number of queued log messages.
+     * @return This buffer on success, otherwise nullptr.
+     */
+    datagram_buf* open(const char* path, const char* app_name,
+      unsigned facility = 1, unsigned batch = 16, unsigned capacity = 256);
+
+    /**
+     * Sends remaining log messages, waiting a bounded time for the agent,
+     * and closes the socket.
+     *
+     * @return This buffer if all log messages were sent, otherwise nullptr.
+     */
+    datagram_buf* close();
+
+    /**
+     * Sends queued log messages without blocking.
+     *
+     * @return Number of log messages still queued.
+     */
+    std::size_t send();
+
+    /**
+     * Gets the number of log messages dropped because the queue was full.
+     *
+     * @return Number of dropped log messages.
+     */
+    std::uint64_t dropped() const noexcept {
+      return lost;
+    }
+
+  protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+  private:
+    // Gets the slot of the queued log message at the specified index.
+    char* slot(std::size_t index) noexcept;
+
+    // Starts writing the next log message into a free slot.
+    void next();
+
+    // Connects a new socket to the agent, unless attempted recently.
+    bool reconnect();
+
+    // Socket connected to the agent, and the socket path.
+    int fd = -1;
+    std::string path;
+
+    // Time of the last attempt to reconnect, in milliseconds.
+    std::int64_t reconnected = 0;
+
+    // Header fields following the priority, i.e. version, timestamp,
+    // hostname, app name, process id, message id and structured data.
+    char fields[detail::datagram_prefix_size - 8];
+    unsigned fields_size = 0;
+
+    // Syslog facility.
+    unsigned facility = 0;
+
+    // Log messages per batch.
+    unsigned batch = 0;
+
+    // Ring of fixed size slots holding queued log messages, with one spare
+    // slot for the log message being written. Each slot starts with the
+    // header size and message size, followed by the reserved header room
+    // and the log message.
+    std::vector<char> slots;
+    std::size_t capacity = 0;
+    std::size_t first = 0;
+    std::size_t count = 0;
+
+    // Time the oldest queued log message was queued, in milliseconds.
+    std::int64_t oldest = 0;
+
+    // Number of dropped log messages.
+    std::uint64_t lost = 0;
+  };
+}
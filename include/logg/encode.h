@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <type_traits>
+
+#include "logg.h"
+
+namespace logg::detail {
+  // Binary payload to be written as hexadecimal.
+  struct hex_bytes {
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t limit;
+  };
+
+  // Binary payload to be written as base64.
+  struct base64_bytes {
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t limit;
+  };
+
+  // Encodes bytes as lowercase hexadecimal, two characters per byte.
+  void encode_hex(const unsigned char* src, std::size_t size, char* dst)
+    noexcept;
+
+  // Encodes bytes as padded base64. Returns the number of characters
+  // written, four per started group of three bytes.
+  std::size_t encode_base64(const unsigned char* src, std::size_t size,
+    char* dst) noexcept;
+
+  // Writes characters to the log stream, widening them if needed.
+  template<class Char, class Traits>
+  void write_chars(std::basic_ostream<Char, Traits>& os, const char* buf,
+      std::size_t size) {
+    if constexpr (std::is_same_v<Char, char>) {
+      os.write(buf, size);
+    } else {
+      for (std::size_t i = 0; i < size; i++) {
+        os.put(os.widen(buf[i]));
+      }
+    }
+  }
+
+  // Writes the truncation marker of a payload longer than its limit.
+  template<class Char, class Traits>
+  void write_truncated(std::basic_ostream<Char, Traits>& os,
+      std::size_t size) {
+    char buf[32];
+    auto n = std::snprintf(buf, sizeof (buf), "... (%zu bytes)", size);
+    write_chars(os, buf, n);
+  }
+}
+
+namespace logg {
+  /**
+   * Returns a manipulator writing binary data as lowercase hexadecimal.
+   *
+   * @param data Data.
+   * @param size Data size in bytes.
+   * @param limit Maximum number of bytes written, the rest is truncated.
+   * @return Manipulator.
+   */
+  inline detail::hex_bytes hexdump(const void* data, std::size_t size,
+      std::size_t limit = SIZE_MAX) noexcept {
+    return {static_cast<const unsigned char*>(data), size, limit};
+  }
+
+  /**
+   * Returns a manipulator writing binary data as padded base64.
+   *
+   * @param data Data.
+   * @param size Data size in bytes.
+   * @param limit Maximum number of bytes written, the rest is truncated.
+   * @return Manipulator.
+   */
+  inline detail::base64_bytes base64(const void* data, std::size_t size,
+      std::size_t limit = SIZE_MAX) noexcept {
+    return {static_cast<const unsigned char*>(data), size, limit};
+  }
+}
+
+/**
+ * Writes binary data as hexadecimal to underlaying log stream.
+ *
+ * @tparam Char Character type.
+ * @tparam Traits Character traits.
+ *
+ * @param p Proxy.
+ * @param v Binary data.
+ * @return Proxy.
+ */
+template<unsigned Level, class Char, class Traits>
+const logg::detail::proxy<Level, Char, Traits, true>& operator<<(
+    const logg::detail::proxy<Level, Char, Traits, true>& p,
+    const logg::detail::hex_bytes& v) {
+  char buf[512];
+  auto size = v.size < v.limit ? v.size : v.limit;
+
+  for (std::size_t off = 0; off < size; off += sizeof (buf) / 2) {
+    auto n = size - off < sizeof (buf) / 2 ? size - off : sizeof (buf) / 2;
+    logg::detail::encode_hex(v.data + off, n, buf);
+    logg::detail::write_chars(p.os, buf, 2 * n);
+  }
+
+  if (size < v.size) {
+    logg::detail::write_truncated(p.os, v.size);
+  }
+
+  return p;
+}
+
+/**
+ * Writes binary data as base64 to underlaying log stream.
+ *
+ * @tparam Char Character type.
+ * @tparam Traits Character traits.
+ *
+ * @param p Proxy.
+ * @param v Binary data.
+ * @return Proxy.
+ */
+template<unsigned Level, class Char, class Traits>
+const logg::detail::proxy<Level, Char, Traits, true>& operator<<(
+    const logg::detail::proxy<Level, Char, Traits, true>& p,
+    const logg::detail::base64_bytes& v) {
+  // Chunks are a multiple of three bytes, so only the last one is padded.
+  char buf[512];
+  const std::size_t chunk = sizeof (buf) / 4 * 3;
+  auto size = v.size < v.limit ? v.size : v.limit;
+
+  for (std::size_t off = 0; off < size; off += chunk) {
+    auto n = size - off < chunk ? size - off : chunk;
+    auto len = logg::detail::encode_base64(v.data + off, n, buf);
+    logg::detail::write_chars(p.os, buf, len);
+  }
+
+  if (size < v.size) {
+    logg::detail::write_truncated(p.os, v.size);
+  }
+
+  return p;
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+namespace logg::detail {
+  // Argument categories known by the format string parser.
+  enum class arg_kind {
+    none,
+    boolean,
+    character,
+    integer,
+    floating,
+    string,
+    pointer
+  };
+
+  // Gets the category of an argument type.
+  template<class T>
+  constexpr arg_kind kind_of() noexcept {
+    using D = std::decay_t<T>;
+
+    if constexpr (std::is_same_v<D, bool>) {
+      return arg_kind::boolean;
+    } else if constexpr (std::is_same_v<D, char>) {
+      return arg_kind::character;
+    } else if constexpr (std::is_integral_v<D>) {
+      return arg_kind::integer;
+    } else if constexpr (std::is_floating_point_v<D>) {
+      return arg_kind::floating;
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+      return arg_kind::string;
+    } else if constexpr (std::is_pointer_v<D>) {
+      return arg_kind::pointer;
+    } else {
+      return arg_kind::none;
+    }
+  }
+
+  // Replacement field format specification, i.e. {:.3f}.
+  struct format_spec {
+    char type = 0;
+    int precision = -1;
+  };
+
+  // Deliberately not constexpr. Calling it while parsing a format string at
+  // compile time fails the build, with the message in the diagnostic.
+  void format_error(const char* message);
+
+  // Parses the format specification of the replacement field starting at
+  // index @p i, which is left at the closing brace.
+  constexpr format_spec parse_spec(std::string_view str, std::size_t& i,
+      arg_kind kind) {
+    format_spec spec;
+
+    if (kind == arg_kind::none) {
+      format_error("unsupported argument type");
+    }
+
+    if (i < str.size() && str[i] == ':') {
+      i++;
+
+      if (i < str.size() && str[i] == '.') {
+        spec.precision = 0;
+        for (i++; i < str.size() && str[i] >= '0' && str[i] <= '9'; i++) {
+          spec.precision = spec.precision * 10 + (str[i] - '0');
+          if (spec.precision > 99) {
+            format_error("precision out of range");
+          }
+        }
+
+        if (kind != arg_kind::floating) {
+          format_error("precision used with non floating point argument");
+        }
+      }
+
+      if (i < str.size() && str[i] != '}') {
+        spec.type = str[i++];
+      }
+    }
+
+    if (i >= str.size() || str[i] != '}') {
+      format_error("unterminated replacement field");
+    }
+
+    switch (spec.type) {
+      case 0:
+        break;
+      case 'd': case 'x': case 'X': case 'o': case 'b':
+        if (kind != arg_kind::integer && kind != arg_kind::character &&
+            (kind != arg_kind::pointer || spec.type != 'x')) {
+          format_error("integer presentation type used with non integer");
+        }
+        break;
+      case 'f': case 'e': case 'g':
+        if (kind != arg_kind::floating) {
+          format_error("floating point presentation type used with non "
+            "floating point argument");
+        }
+        break;
+      default:
+        format_error("unknown presentation type");
+    }
+
+    return spec;
+  }
+
+  // Format string checked against the argument types at compile time.
+  template<class... Args>
+  struct format_string {
+    template<class String, class = std::enable_if_t<
+      std::is_convertible_v<const String&, std::string_view>>>
+    consteval format_string(const String& s)
+        : str(s) {
+      constexpr arg_kind kinds[] = {kind_of<Args>()..., arg_kind::none};
+      std::size_t n = 0;
+
+      for (std::size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '}') {
+          if (i + 1 < str.size() && str[i + 1] == '}') {
+            i++;
+            continue;
+          }
+          format_error("unmatched '}' in format string");
+        }
+
+        if (str[i] != '{') {
+          continue;
+        }
+
+        if (i + 1 < str.size() && str[i + 1] == '{') {
+          i++;
+          continue;
+        }
+
+        if (n == sizeof...(Args)) {
+          format_error("too few arguments for format string");
+        }
+
+        specs[n] = parse_spec(str, ++i, kinds[n]);
+        n++;
+      }
+
+      if (n != sizeof...(Args)) {
+        format_error("too many arguments for format string");
+      }
+    }
+
+    // Format string.
+    std::string_view str;
+
+    // Parsed format specifications, one per argument.
+    std::array<format_spec, sizeof...(Args)> specs{};
+  };
+
+  // Formats into a stack buffer, written to the log stream when full or
+  // when flushed. Never touches the formatting state of the log stream.
+  template<class Char, class Traits>
+  class format_writer {
+  public:
+    explicit format_writer(std::basic_ostream<Char, Traits>& os) noexcept
+        : os(os) {}
+
+    ~format_writer() {
+      flush();
+    }
+
+    // Writes the literal text up to the next replacement field, and skips
+    // past the field. Returns the position following the field.
+    const char* literal(const char* p, const char* end) {
+      while (p < end) {
+        auto c = *p++;
+
+        if (c == '{' || c == '}') {
+          if (p < end && *p == c) {
+            p++;
+          } else {
+            while (c == '{' && *p++ != '}') {}
+            break;
+          }
+        }
+
+        put(c);
+      }
+
+      return p;
+    }
+
+    template<class T>
+    void value(const format_spec& spec, const T& v) {
+      constexpr auto kind = kind_of<T>();
+
+      if constexpr (kind == arg_kind::boolean) {
+        write(v ? "true" : "false");
+      } else if constexpr (kind == arg_kind::character) {
+        if (spec.type) {
+          number(static_cast<int>(v), spec);
+        } else {
+          put(v);
+        }
+      } else if constexpr (kind == arg_kind::integer ||
+          kind == arg_kind::floating) {
+        number(v, spec);
+      } else if constexpr (kind == arg_kind::string) {
+        if constexpr (std::is_pointer_v<T>) {
+          write(v ? std::string_view(v) : "(null)");
+        } else {
+          write(std::string_view(v));
+        }
+      } else if constexpr (kind == arg_kind::pointer) {
+        write("0x");
+        number(reinterpret_cast<std::uintptr_t>(v), format_spec{'x'});
+      }
+    }
+
+    // Writes a string.
+    void write(std::string_view s) {
+      while (!s.empty()) {
+        if (pos == sizeof (buf)) {
+          flush();
+        }
+
+        auto n = std::min(s.size(), sizeof (buf) - pos);
+        s.copy(buf + pos, n);
+        pos += n;
+        s.remove_prefix(n);
+      }
+    }
+
+    // Writes the buffered characters to the log stream.
+    void flush() {
+      if constexpr (std::is_same_v<Char, char>) {
+        os.write(buf, pos);
+      } else {
+        for (std::size_t i = 0; i < pos; i++) {
+          os.put(os.widen(buf[i]));
+        }
+      }
+
+      pos = 0;
+    }
+
+  private:
+    void put(char c) {
+      if (pos == sizeof (buf)) {
+        flush();
+      }
+      buf[pos++] = c;
+    }
+
+    template<class T>
+    void number(T v, const format_spec& spec) {
+      auto r = to_chars(buf + pos, buf + sizeof (buf), v, spec);
+
+      // Retried once with an empty buffer, which fits any number except
+      // huge floating point numbers in fixed notation. These are written
+      // in scientific notation instead.
+      if (r.ec != std::errc()) {
+        flush();
+        r = to_chars(buf, buf + sizeof (buf), v, spec);
+
+        if constexpr (std::is_floating_point_v<T>) {
+          if (r.ec != std::errc()) {
+            auto scientific = spec;
+            scientific.type = 'e';
+            r = to_chars(buf, buf + sizeof (buf), v, scientific);
+          }
+        }
+
+        if (r.ec != std::errc()) {
+          return;
+        }
+      }
+
+      if (spec.type == 'X') {
+        for (auto p = buf + pos; p < r.ptr; p++) {
+          *p = *p >= 'a' && *p <= 'f' ? *p - 'a' + 'A' : *p;
+        }
+      }
+
+      pos = r.ptr - buf;
+    }
+
+    template<class T>
+    static std::to_chars_result to_chars(char* first, char* last, T v,
+        const format_spec& spec) {
+      if constexpr (std::is_floating_point_v<T>) {
+        auto fmt = spec.type == 'f' ? std::chars_format::fixed
+          : spec.type == 'e' ? std::chars_format::scientific
+          : std::chars_format::general;
+
+        if (spec.precision >= 0) {
+          return std::to_chars(first, last, v, fmt, spec.precision);
+        } else if (spec.type) {
+          return std::to_chars(first, last, v, fmt);
+        } else {
+          return std::to_chars(first, last, v);
+        }
+      } else {
+        auto base = spec.type == 'x' || spec.type == 'X' ? 16
+          : spec.type == 'o' ? 8
+          : spec.type == 'b' ? 2
+          : 10;
+        return std::to_chars(first, last, v, base);
+      }
+    }
+
+    // Underlaying log stream.
+    std::basic_ostream<Char, Traits>& os;
+
+    // Formatted characters not yet written to the log stream.
+    char buf[512];
+    std::size_t pos = 0;
+  };
+
+  // Formats the arguments according to the format string and writes the
+  // result to the log stream.
+  template<class Char, class Traits, class... Args>
+  void format(std::basic_ostream<Char, Traits>& os,
+      const format_string<Args...>& fmt, const Args&... args) {
+    format_writer<Char, Traits> w(os);
+    auto p = fmt.str.data();
+    auto end = p + fmt.str.size();
+    std::size_t i = 0;
+
+    ((p = w.literal(p, end), w.value(fmt.specs[i++], args)), ...);
+    w.literal(p, end);
+  }
+}
@@ -1,6 +1,19 @@
 #pragma once
 
+#include <cstddef>
+
 namespace logg::detail {
   // Fills the specified buffer with the TT part of a TTCC log message.
   unsigned build_header(char* buf, unsigned size);
+
+  // Gets the id of the calling thread, as written in the log message
+  // header. Async-signal-safe.
+  unsigned thread_id() noexcept;
+
+  // Length of the timestamp starting each log message header.
+  constexpr const unsigned timestamp_size = 19;
+
+  // Parses the log level from the log message header at the start of the
+  // specified buffer. Returns OFF if the buffer doesn't start with a header.
+  unsigned parse_level(const char* buf, std::size_t size) noexcept;
 }
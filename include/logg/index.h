@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace logg::detail {
+  // Entry in the sidecar index of a log file. Maps a point in time to the
+  // offset of the first log message written after it.
+  struct index_entry {
+    std::int64_t time;
+    std::uint64_t offset;
+  };
+
+  // Suffix added to the log file name to get the sidecar index file name.
+  constexpr const char index_suffix[] = ".idx";
+}
+
+namespace logg {
+  /**
+   * File stream buffer writing a sparse time index next to the log file.
+   *
+   * Each time at least @p interval bytes have been written to the log file
+   * since the previous index entry, an entry mapping the current time to the
+   * current file offset is appended to the index file. The index file is
+   * named as the log file with the suffix ".idx". Entries are written on
+   * sync only, i.e. when a log message has been completed, so each entry
+   * always points to the start of a log message.
+   *
+   * The log file and the index file are both opened for appending, making
+   * it possible to reopen a log file after it has been rotated. The index
+   * file is truncated when the log file is found to be empty or shorter
+   * than the index file expects, i.e. rotated by renaming or truncated.
+   */
+  class index_filebuf : public std::filebuf {
+  public:
+    ~index_filebuf() override;
+
+    /**
+     * Opens the log file and its index file for appending.
+     *
+     * @param path Log file path.
+     * @param interval Minimum number of bytes between index entries.
+     * @return This buffer on success, otherwise nullptr.
+     */
+    index_filebuf* open(const char* path, unsigned interval = 64 * 1024);
+
+    /**
+     * Flushes and closes the log file and its index file.
+     *
+     * @return This buffer on success, otherwise nullptr.
+     */
+    index_filebuf* close();
+
+  protected:
+    int sync() override;
+
+  private:
+    // Sidecar index file.
+    std::filebuf idx;
+    std::string index_path;
+
+    // Minimum number of bytes between index entries.
+    unsigned interval = 0;
+
+    // Log file offset of the last index entry.
+    std::streamoff last = 0;
+  };
+}
@@ -4,14 +4,23 @@
 #include <ostream>
 
 #include "config.h"
+#include "context.h"
 #include "header.h"
 #include "source.h"
 
+// The format string API needs consteval, i.e. C++20.
+#ifdef __cpp_consteval
+#include "format.h"
+#endif
+
 namespace logg::detail {
   // Level template, contains functions for writing the level and location
   // of the logg message header.
   template<unsigned Level>
   struct level {
+    // Custom log levels have no name, written as CUSTOM(level).
+    static constexpr const char* name = nullptr;
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::snprintf(buf, size, " CUSTOM(%d) - ", Level);
     }
@@ -30,6 +39,8 @@ namespace logg::detail {
   // Level template specializations for the standard log levels.
   template<>
   struct level<FATAL> {
+    static constexpr const char* name = "FATAL";
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::strncpy(buf, " FATAL - ", size);
     }
@@ -47,6 +58,8 @@ namespace logg::detail {
 
   template<>
   struct level<ERROR> {
+    static constexpr const char* name = "ERROR";
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::strncpy(buf, " ERROR - ", size);
     }
@@ -64,6 +77,8 @@ namespace logg::detail {
 
   template<>
   struct level<WARN> {
+    static constexpr const char* name = "WARN";
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::strncpy(buf, " WARN - ", size);
     }
@@ -81,6 +96,8 @@ namespace logg::detail {
 
   template<>
   struct level<INFO> {
+    static constexpr const char* name = "INFO";
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::strncpy(buf, " INFO - ", size);
     }
@@ -98,6 +115,8 @@ namespace logg::detail {
 
   template<>
   struct level<DEBUG> {
+    static constexpr const char* name = "DEBUG";
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::strncpy(buf, " DEBUG - ", size);
     }
@@ -115,6 +134,8 @@ namespace logg::detail {
 
   template<>
   struct level<TRACE> {
+    static constexpr const char* name = "TRACE";
+
     static void write_header(char* buf, unsigned size) noexcept {
       std::strncpy(buf, " TRACE - ", size);
     }
@@ -136,6 +157,15 @@ namespace logg::detail {
     proxy(std::basic_ostream<Char, Traits>&) noexcept {}
     proxy(std::basic_ostream<Char, Traits>&, const function&) noexcept {}
     proxy(std::basic_ostream<Char, Traits>&, const source&) noexcept {}
+
+#ifdef __cpp_consteval
+    // Discards the arguments, the format string is still checked.
+    template<class... Args>
+    const proxy& fmt(format_string<std::type_identity_t<Args>...>,
+        const Args&...) const noexcept {
+      return *this;
+    }
+#endif
   };
 
   // Proxy template specialization. Used when logging is enabled.
@@ -143,24 +173,27 @@ namespace logg::detail {
   struct proxy<Level, Char, Traits, true> {
     proxy(std::basic_ostream<Char, Traits>& os)
         : os(os) {
-      char buf[128];
+      char buf[256];
       auto off = build_header(buf, sizeof (buf));
+      off += write_context(buf + off, sizeof (buf) - off);
       level<Level>::write_header(buf + off, sizeof (buf) - off);
       os << buf;
     }
 
     proxy(std::basic_ostream<Char, Traits>& os, const function& fun)
         : os(os) {
-      char buf[128];
+      char buf[256];
       auto off = build_header(buf, sizeof (buf));
+      off += write_context(buf + off, sizeof (buf) - off);
       level<Level>::write_header(buf + off, sizeof (buf) - off, fun.name);
       os << buf;
     }
 
     proxy(std::basic_ostream<Char, Traits>& os, const source& src)
         : os(os) {
-      char buf[128];
+      char buf[256];
       auto off = build_header(buf, sizeof (buf));
+      off += write_context(buf + off, sizeof (buf) - off);
       level<Level>::write_header(buf + off, sizeof (buf) - off,
         std::strrchr(src.file, logg::detail::separator), src.line);
       os << buf;
@@ -170,6 +203,17 @@ namespace logg::detail {
       os << std::endl;
     }
 
+#ifdef __cpp_consteval
+    // Formats the arguments according to the format string, checked at
+    // compile time, and writes the result to the log stream.
+    template<class... Args>
+    const proxy& fmt(format_string<std::type_identity_t<Args>...> f,
+        const Args&... args) const {
+      format(os, f, args...);
+      return *this;
+    }
+#endif
+
     // Underlaying log stream.
     std::basic_ostream<Char, Traits>& os;
   };
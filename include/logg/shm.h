@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace logg::detail {
+  // Size of a slot in the shared memory ring, log messages longer than what
+  // fits in a slot are truncated.
+  constexpr const std::size_t shm_slot_size = 512;
+
+  // Slot in the shared memory ring. The sequence number tells the state of
+  // the slot. Free slots have the position of the next writer to claim it,
+  // committed slots the position plus one.
+  struct shm_slot {
+    std::atomic<std::uint64_t> seq;
+    std::uint32_t size;
+    char data[shm_slot_size - 12];
+  };
+
+  // Maximum number of writers attached to a ring at the same time.
+  constexpr const std::size_t shm_max_writers = 256;
+
+  // Header of the shared memory segment, followed by the slots.
+  struct shm_ring {
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t capacity;
+    std::atomic<std::uint64_t> dropped;
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+
+    // Position plus one of the slot claimed by each writer, or zero.
+    alignas(64) std::atomic<std::uint64_t> claims[shm_max_writers];
+  };
+
+  // Magic identifying an initialized ring, "LGSR".
+  constexpr const std::uint32_t shm_magic = 0x5253474c;
+
+  // Maps the shared memory segment and stores the mapped size. When
+  // creating, an existing ring is attached to only if it has the specified
+  // capacity. Returns nullptr on failure.
+  shm_ring* map_ring(int fd, std::uint32_t capacity, bool create,
+    std::size_t& size);
+
+  // Unmaps a shared memory segment.
+  void unmap_ring(shm_ring* ring, std::size_t size);
+
+  // Gets the slots following the ring header.
+  inline shm_slot* slots(shm_ring* ring) noexcept {
+    return reinterpret_cast<shm_slot*>(ring + 1);
+  }
+}
+
+namespace logg {
+  /**
+   * Stream buffer writing log messages to a shared memory ring.
+   *
+   * Any number of processes and threads may write to the same ring, each
+   * using its own stream buffer. Each log message is collected in the
+   * stream buffer and published to a slot of the ring on sync, i.e. when the
+   * log message has been completed. Writers never block, when the ring is
+   * full the log message is dropped and counted. The ring is created and
+   * drained by a logg::shm_collector.
+   *
+   * Each stream buffer holds a lock identifying it as a live writer, at
+   * most 256 stream buffers can be attached to a ring at the same time.
+   */
+  class shm_buf : public std::streambuf {
+  public:
+    shm_buf() = default;
+    ~shm_buf() override;
+
+    shm_buf(const shm_buf&) = delete;
+    shm_buf& operator=(const shm_buf&) = delete;
+
+    /**
+     * Maps the ring in the named shared memory segment.
+     *
+     * @param name Shared memory segment name, e.g. "/app-log".
+     * @return This buffer on success, otherwise nullptr.
+     */
+    shm_buf* open(const char* name);
+
+    /**
+     * Unmaps the ring, any incomplete log message is discarded.
+     */
+    void close();
+
+  protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+  private:
+    // Opens the segment and takes a free writer id.
+    bool attach();
+
+    // Shared memory segment.
+    std::string name;
+    int fd = -1;
+
+    // Mapped ring.
+    detail::shm_ring* ring = nullptr;
+    std::size_t mapped = 0;
+
+    // Writer id, locked by the process which opened the segment.
+    std::size_t id = 0;
+    int pid = 0;
+
+    // Log message being written.
+    char buf[sizeof (detail::shm_slot::data)];
+  };
+
+  /**
+   * Collector draining a shared memory ring.
+   *
+   * Creates the ring, or attaches to an existing ring left by a previous
+   * collector, and writes committed log messages to a log stream. A writer
+   * dying while writing a log message leaves its slot uncommitted. Such a
+   * slot is skipped once the lock held by the writer has been released,
+   * so that the ring never wedges. The slot of a live writer is never
+   * skipped, a stopped writer holds back the collector until resumed.
+   */
+  class shm_collector {
+  public:
+    shm_collector() = default;
+    ~shm_collector();
+
+    shm_collector(const shm_collector&) = delete;
+    shm_collector& operator=(const shm_collector&) = delete;
+
+    /**
+     * Creates or attaches to the ring in the named shared memory segment.
+     * An existing ring is never resized, since writers may have it mapped,
+     * attaching fails if its capacity differs.
+     *
+     * @param name Shared memory segment name, e.g. "/app-log".
+     * @param capacity Number of slots, must be a power of two.
+     * @return This collector on success, otherwise nullptr.
+     */
+    shm_collector* open(const char* name, std::uint32_t capacity = 4096);
+
+    /**
+     * Unmaps the ring. The shared memory segment is kept so that a new
+     * collector can attach to it.
+     */
+    void close();
+
+    /**
+     * Writes all committed log messages to the log stream. The log stream
+     * is flushed before the slots of the log messages are released, so
+     * that no log message taken from the ring is lost if the collector
+     * crashes. Slots are kept if flushing fails.
+     *
+     * @param os Log stream.
+     * @return Number of log messages written.
+     */
+    std::size_t drain(std::ostream& os);
+
+    /**
+     * Gets the number of log messages dropped, because the ring was full
+     * or the writer died before completing it.
+     *
+     * @return Number of dropped log messages.
+     */
+    std::uint64_t dropped() const noexcept;
+
+  private:
+    // Tells whether the slot at the position is claimed by a live writer.
+    bool is_owned(std::uint64_t pos) const;
+
+    // Shared memory segment, kept open to query the locks of writers.
+    int fd = -1;
+
+    // Mapped ring.
+    detail::shm_ring* ring = nullptr;
+    std::size_t mapped = 0;
+  };
+}
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "logg.h"
+
+namespace logg {
+  /**
+   * Async-signal-safe log stream.
+   *
+   * Log messages are formatted into a stack buffer using reentrant code and
+   * written to the file descriptor using a single call to write(2), without
+   * locks, heap allocations or locale. This makes it safe to log from signal
+   * handlers and from a child process between fork and exec.
+   *
+   * Timestamps are written in local time, using the UTC offset in effect
+   * when the stream was created. Only strings, characters, booleans,
+   * integers and pointers can be written.
+   */
+  class signal_safe {
+  public:
+    /**
+     * Creates a log stream writing to a file descriptor. Must not be called
+     * from a signal handler.
+     *
+     * @param fd File descriptor.
+     */
+    explicit signal_safe(int fd);
+
+    // File descriptor written to.
+    const int fd;
+
+    // Local time UTC offset in seconds.
+    const long utc_offset;
+  };
+}
+
+namespace logg::detail {
+  // Fixed size buffer formatting log messages using reentrant code only.
+  // Characters not fitting in the buffer are discarded.
+  class signal_writer {
+  public:
+    void append(char c) noexcept {
+      if (size < sizeof (buf)) {
+        buf[size++] = c;
+      }
+    }
+
+    void append(const char* s) noexcept {
+      for (; s && *s; s++) {
+        append(*s);
+      }
+    }
+
+    void append(std::string_view s) noexcept {
+      for (auto c : s) {
+        append(c);
+      }
+    }
+
+    void append(unsigned long long v, unsigned base = 10,
+        unsigned width = 0) noexcept {
+      char tmp[64];
+      unsigned n = 0;
+
+      do {
+        tmp[n++] = "0123456789abcdef"[v % base];
+        v /= base;
+      } while (v > 0 || n < width);
+
+      while (n > 0) {
+        append(tmp[--n]);
+      }
+    }
+
+    void append(long long v) noexcept {
+      if (v < 0) {
+        append('-');
+        append(0ull - static_cast<unsigned long long>(v));
+      } else {
+        append(static_cast<unsigned long long>(v));
+      }
+    }
+
+    // Terminates the log message and writes it to the file descriptor.
+    void write(int fd) noexcept;
+
+    // Writes the TT part of a TTCC log message.
+    void write_header(long utc_offset) noexcept;
+
+    // Writes the level part of a TTCC log message.
+    template<unsigned Level>
+    void write_level() noexcept {
+      append(' ');
+      if constexpr (level<Level>::name != nullptr) {
+        append(level<Level>::name);
+      } else {
+        append("CUSTOM(");
+        append(static_cast<unsigned long long>(Level));
+        append(')');
+      }
+    }
+
+  private:
+    char buf[512];
+    unsigned size = 0;
+  };
+
+  // Signal safe proxy template. Has no state, discards all constructor
+  // parameters.
+  template<unsigned Level, bool Enable>
+  struct signal_proxy {
+    signal_proxy(const signal_safe&) noexcept {}
+    signal_proxy(const signal_safe&, const function&) noexcept {}
+    signal_proxy(const signal_safe&, const source&) noexcept {}
+  };
+
+  // Signal safe proxy template specialization. Used when logging is
+  // enabled.
+  template<unsigned Level>
+  struct signal_proxy<Level, true> {
+    signal_proxy(const signal_safe& out) noexcept
+        : out(out) {
+      w.write_header(out.utc_offset);
+      w.template write_level<Level>();
+      w.append(" - ");
+    }
+
+    signal_proxy(const signal_safe& out, const function& fun) noexcept
+        : out(out) {
+      w.write_header(out.utc_offset);
+      w.template write_level<Level>();
+      w.append(" {");
+      w.append(fun.name);
+      w.append("} - ");
+    }
+
+    signal_proxy(const signal_safe& out, const source& src) noexcept
+        : out(out) {
+      auto file = src.file;
+      for (auto p = src.file; *p; p++) {
+        if (*p == separator) {
+          file = p + 1;
+        }
+      }
+
+      w.write_header(out.utc_offset);
+      w.template write_level<Level>();
+      w.append(" {");
+      w.append(file);
+      w.append(':');
+      w.append(static_cast<unsigned long long>(src.line));
+      w.append("} - ");
+    }
+
+    ~signal_proxy() {
+      w.write(out.fd);
+    }
+
+    // Underlaying log stream.
+    const signal_safe& out;
+
+    // Log message being formatted.
+    mutable signal_writer w;
+  };
+}
+
+namespace logg {
+  // Alias template.
+  template<unsigned Level>
+  using signal_proxy = detail::signal_proxy<Level, Level <= detail::log_level>;
+
+  /**
+   * Returns a signal safe logger with log level set to @p Level.
+   *
+   * @tparam Level Log level.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  template<unsigned Level>
+  signal_proxy<Level> log(const signal_safe& out) noexcept {
+    return signal_proxy<Level>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to @p Level.
+   *
+   * @tparam Level Log level.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  template<unsigned Level>
+  signal_proxy<Level> log(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<Level>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to @p Level.
+   *
+   * @tparam Level Log level.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  template<unsigned Level>
+  signal_proxy<Level> log(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<Level>(out, src);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to FATAL.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  inline signal_proxy<FATAL> fatal(const signal_safe& out) noexcept {
+    return signal_proxy<FATAL>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to FATAL.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  inline signal_proxy<FATAL> fatal(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<FATAL>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to FATAL.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  inline signal_proxy<FATAL> fatal(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<FATAL>(out, src);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to ERROR.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  inline signal_proxy<ERROR> error(const signal_safe& out) noexcept {
+    return signal_proxy<ERROR>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to ERROR.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  inline signal_proxy<ERROR> error(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<ERROR>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to ERROR.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  inline signal_proxy<ERROR> error(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<ERROR>(out, src);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to WARN.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  inline signal_proxy<WARN> warn(const signal_safe& out) noexcept {
+    return signal_proxy<WARN>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to WARN.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  inline signal_proxy<WARN> warn(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<WARN>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to WARN.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  inline signal_proxy<WARN> warn(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<WARN>(out, src);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to INFO.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  inline signal_proxy<INFO> info(const signal_safe& out) noexcept {
+    return signal_proxy<INFO>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to INFO.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  inline signal_proxy<INFO> info(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<INFO>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to INFO.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  inline signal_proxy<INFO> info(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<INFO>(out, src);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to DEBUG.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  inline signal_proxy<DEBUG> debug(const signal_safe& out) noexcept {
+    return signal_proxy<DEBUG>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to DEBUG.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  inline signal_proxy<DEBUG> debug(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<DEBUG>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to DEBUG.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  inline signal_proxy<DEBUG> debug(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<DEBUG>(out, src);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to TRACE.
+   *
+   * @param out Signal safe log stream.
+   * @return Logger.
+   */
+  inline signal_proxy<TRACE> trace(const signal_safe& out) noexcept {
+    return signal_proxy<TRACE>(out);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to TRACE.
+   *
+   * @param out Signal safe log stream.
+   * @param fun Source function.
+   * @return Logger.
+   */
+  inline signal_proxy<TRACE> trace(
+      const signal_safe& out, const detail::function& fun) noexcept {
+    return signal_proxy<TRACE>(out, fun);
+  }
+
+  /**
+   * Returns a signal safe logger with log level set to TRACE.
+   *
+   * @param out Signal safe log stream.
+   * @param src Source location.
+   * @return Logger.
+   */
+  inline signal_proxy<TRACE> trace(
+      const signal_safe& out, const detail::source& src) noexcept {
+    return signal_proxy<TRACE>(out, src);
+  }
+}
+
+/**
+ * Writes string to the signal safe log message.
+ *
+ * @param p Proxy.
+ * @param v Value.
+ * @return Proxy.
+ */
+template<unsigned Level>
+const logg::detail::signal_proxy<Level, true>& operator<<(
+    const logg::detail::signal_proxy<Level, true>& p,
+    std::string_view v) noexcept {
+  p.w.append(v);
+  return p;
+}
+
+/**
+ * Writes null terminated string to the signal safe log message.
+ *
+ * @param p Proxy.
+ * @param v Value.
+ * @return Proxy.
+ */
+template<unsigned Level>
+const logg::detail::signal_proxy<Level, true>& operator<<(
+    const logg::detail::signal_proxy<Level, true>& p, const char* v) noexcept {
+  p.w.append(v);
+  return p;
+}
+
+/**
+ * Writes character, boolean or integer to the signal safe log message.
+ *
+ * @tparam Value Integral type.
+ *
+ * @param p Proxy.
+ * @param v Value.
+ * @return Proxy.
+ */
+template<unsigned Level, class Value,
+  class = std::enable_if_t<std::is_integral_v<Value>>>
+const logg::detail::signal_proxy<Level, true>& operator<<(
+    const logg::detail::signal_proxy<Level, true>& p, Value v) noexcept {
+  if constexpr (std::is_same_v<Value, bool>) {
+    p.w.append(v ? "true" : "false");
+  } else if constexpr (std::is_same_v<Value, char>) {
+    p.w.append(v);
+  } else if constexpr (std::is_signed_v<Value>) {
+    p.w.append(static_cast<long long>(v));
+  } else {
+    p.w.append(static_cast<unsigned long long>(v));
+  }
+  return p;
+}
+
+/**
+ * Writes pointer to the signal safe log message, in hexadecimal.
+ *
+ * @param p Proxy.
+ * @param v Value.
+ * @return Proxy.
+ */
+template<unsigned Level>
+const logg::detail::signal_proxy<Level, true>& operator<<(
+    const logg::detail::signal_proxy<Level, true>& p, const void* v) noexcept {
+  p.w.append("0x");
+  p.w.append(
+    static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(v)), 16);
+  return p;
+}
+
+/**
+ * Discards value.
+ *
+ * @param p Proxy.
+ * @param v Value
+ * @return Proxy.
+ */
+template<unsigned Level, class Value>
+const logg::detail::signal_proxy<Level, false>& operator<<(
+    const logg::detail::signal_proxy<Level, false>& p,
+    const Value& v) noexcept {
+  return p;
+}
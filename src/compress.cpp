@@ -0,0 +1,261 @@
+#include <string.h>
+
+#ifdef LOGG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "logg/compress.h"
+#include "logg/header.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Blocks are handed over on sync once filled to this fraction, so that
+  // blocks end on a log message boundary whenever possible.
+  constexpr std::size_t sync_threshold(std::size_t block_size) {
+    return block_size - block_size / 8;
+  }
+
+  // Blocks waiting to be compressed before the caller is held back.
+  constexpr const std::size_t max_pending = 8;
+}
+
+void logg::detail::encode_block(const char* src, std::size_t size,
+    std::vector<char>& out) {
+  block_header header{block_magic, STORED, static_cast<std::uint32_t>(size),
+    0};
+
+#ifdef LOGG_HAVE_ZSTD
+  out.resize(sizeof (header) + ZSTD_compressBound(size));
+  auto n = ZSTD_compress(out.data() + sizeof (header),
+    out.size() - sizeof (header), src, size, 3);
+  if (!ZSTD_isError(n)) {
+    header.codec = ZSTD;
+    header.size = static_cast<std::uint32_t>(n);
+  }
+#else
+  out.resize(sizeof (header) + lz4_bound(size));
+  header.codec = LZ4;
+  header.size = static_cast<std::uint32_t>(
+    lz4_compress(src, size, out.data() + sizeof (header)));
+#endif
+
+  // Store the block as is if compressing didn't pay off.
+  if (header.codec == STORED || header.size >= size) {
+    header.codec = STORED;
+    header.size = static_cast<std::uint32_t>(size);
+    out.resize(sizeof (header) + size);
+    memcpy(out.data() + sizeof (header), src, size);
+  }
+
+  memcpy(out.data(), &header, sizeof (header));
+  out.resize(sizeof (header) + header.size);
+}
+
+bool logg::detail::decode_block(const block_header& header, const char* src,
+    char* dst) noexcept {
+  switch (header.codec) {
+    case STORED:
+      if (header.size != header.raw_size) {
+        return false;
+      }
+      memcpy(dst, src, header.size);
+      return true;
+
+    case LZ4:
+      return lz4_decompress(src, header.size, dst, header.raw_size);
+
+#ifdef LOGG_HAVE_ZSTD
+    case ZSTD:
+      return ZSTD_decompress(dst, header.raw_size, src, header.size) ==
+        header.raw_size;
+#endif
+
+    default:
+      return false;
+  }
+}
+
+logg::compress_buf::~compress_buf() {
+  close();
+}
+
+logg::compress_buf* logg::compress_buf::open(const char* path,
+    std::size_t block_size, unsigned flush_level,
+    std::chrono::milliseconds max_age) {
+  if (file || block_size == 0 || block_size > max_block_size) {
+    return nullptr;
+  }
+
+  file = std::fopen(path, "ab");
+  if (!file) {
+    return nullptr;
+  }
+
+  this->block_size = block_size;
+  this->flush_level = flush_level;
+  this->max_age = max_age;
+  block.resize(block_size);
+  setp(block.data(), block.data() + block.size());
+  record = pbase();
+  since = {};
+  spanned = OFF;
+
+  done = false;
+  failed = false;
+  worker = std::thread(&compress_buf::run, this);
+
+  return this;
+}
+
+logg::compress_buf* logg::compress_buf::close() {
+  if (!file) {
+    return nullptr;
+  }
+
+  submit();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+
+  cond.notify_all();
+  worker.join();
+
+  auto ok = std::fclose(file) == 0 && !failed;
+  file = nullptr;
+  setp(nullptr, nullptr);
+
+  return ok ? this : nullptr;
+}
+
+logg::compress_buf::int_type logg::compress_buf::overflow(int_type c) {
+  if (!file) {
+    return traits_type::eof();
+  }
+
+  // Carry a partial log message over to the next block, so that blocks end
+  // on a log message boundary and its header stays in one piece. Longer
+  // log messages span blocks, their level is kept for the flush policy.
+  std::size_t size = pptr() - record;
+  if (record != pbase() && size < block_size / 2) {
+    submit(size);
+  } else {
+    if (spanned == OFF) {
+      spanned = parse_level(record, size);
+    }
+    submit();
+  }
+
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+
+  return traits_type::not_eof(c);
+}
+
+int logg::compress_buf::sync() {
+  if (!file) {
+    return -1;
+  }
+
+  auto level = spanned != OFF ? spanned : parse_level(record, pptr() - record);
+  auto severe = level != OFF && level <= flush_level;
+  spanned = OFF;
+  record = pptr();
+
+  auto seq = submitted;
+  if (severe || std::size_t(pptr() - pbase()) >= sync_threshold(block_size)) {
+    seq = submit();
+  } else if (max_age.count() > 0) {
+    auto now = std::chrono::steady_clock::now();
+    if (since == std::chrono::steady_clock::time_point()) {
+      since = now;
+    } else if (now - since >= max_age) {
+      submit();
+    }
+  }
+
+  // Wait for severe log messages to be written, the caller may be about to
+  // crash.
+  if (severe) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this, seq] { return written >= seq; });
+    return failed ? -1 : 0;
+  }
+
+  return 0;
+}
+
+std::uint64_t logg::compress_buf::submit(std::size_t keep) {
+  auto size = pptr() - pbase() - keep;
+  if (size == 0) {
+    return submitted;
+  }
+
+  std::vector<char> next;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return pending.size() < max_pending; });
+
+    if (!pool.empty()) {
+      next = std::move(pool.back());
+      pool.pop_back();
+    }
+
+    next.resize(block_size);
+    memcpy(next.data(), pptr() - keep, keep);
+
+    block.resize(size);
+    pending.push_back(std::move(block));
+    submitted++;
+  }
+
+  cond.notify_all();
+
+  block = std::move(next);
+  setp(block.data(), block.data() + block.size());
+  pbump(static_cast<int>(keep));
+  record = pbase();
+  since = {};
+
+  return submitted;
+}
+
+void logg::compress_buf::run() {
+  std::vector<char> out;
+
+  for (;;) {
+    std::vector<char> raw;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [this] { return done || !pending.empty(); });
+
+      if (pending.empty()) {
+        return;
+      }
+
+      raw = std::move(pending.front());
+      pending.pop_front();
+    }
+
+    cond.notify_all();
+
+    encode_block(raw.data(), raw.size(), out);
+    auto ok = std::fwrite(out.data(), 1, out.size(), file) == out.size() &&
+      std::fflush(file) == 0;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = failed || !ok;
+      pool.push_back(std::move(raw));
+      written++;
+    }
+
+    cond.notify_all();
+  }
+}
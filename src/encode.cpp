@@ -0,0 +1,166 @@
+#include "logg/encode.h"
+
+// SIMD kernels are compiled for x86 using GCC compatible target attributes
+// and selected at runtime based on the features of the CPU.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LOGG_DETAIL_X86
+#include <immintrin.h>
+#endif
+
+using namespace logg::detail;
+
+namespace {
+  const char hex_digits[] = "0123456789abcdef";
+
+  const char base64_digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  void hex_scalar(const unsigned char* src, std::size_t size, char* dst) {
+    for (std::size_t i = 0; i < size; i++) {
+      *dst++ = hex_digits[src[i] >> 4];
+      *dst++ = hex_digits[src[i] & 0xf];
+    }
+  }
+
+  std::size_t base64_scalar(const unsigned char* src, std::size_t size,
+      char* dst) {
+    auto p = dst;
+
+    for (; size >= 3; src += 3, size -= 3) {
+      std::uint32_t v = src[0] << 16 | src[1] << 8 | src[2];
+      *p++ = base64_digits[v >> 18];
+      *p++ = base64_digits[v >> 12 & 0x3f];
+      *p++ = base64_digits[v >> 6 & 0x3f];
+      *p++ = base64_digits[v & 0x3f];
+    }
+
+    if (size > 0) {
+      std::uint32_t v = src[0] << 16 | (size > 1 ? src[1] << 8 : 0);
+      *p++ = base64_digits[v >> 18];
+      *p++ = base64_digits[v >> 12 & 0x3f];
+      *p++ = size > 1 ? base64_digits[v >> 6 & 0x3f] : '=';
+      *p++ = '=';
+    }
+
+    return p - dst;
+  }
+
+#ifdef LOGG_DETAIL_X86
+  // Looks up the hex digit of each nibble, 16 bytes at the time.
+  __attribute__((target("ssse3")))
+  void hex_ssse3(const unsigned char* src, std::size_t size, char* dst) {
+    const auto lut = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(hex_digits));
+    const auto mask = _mm_set1_epi8(0x0f);
+
+    for (; size >= 16; src += 16, dst += 32, size -= 16) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      auto hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4),
+        mask));
+      auto lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+        _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16),
+        _mm_unpackhi_epi8(hi, lo));
+    }
+
+    hex_scalar(src, size, dst);
+  }
+
+  // Same as above, 32 bytes at the time. Unpacking works per 128 bit lane,
+  // the lanes are put back in order before storing.
+  __attribute__((target("avx2")))
+  void hex_avx2(const unsigned char* src, std::size_t size, char* dst) {
+    const auto lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(hex_digits)));
+    const auto mask = _mm256_set1_epi8(0x0f);
+
+    for (; size >= 32; src += 32, dst += 64, size -= 32) {
+      auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+      auto hi = _mm256_shuffle_epi8(lut,
+        _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+      auto lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+      auto a = _mm256_unpacklo_epi8(hi, lo);
+      auto b = _mm256_unpackhi_epi8(hi, lo);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+        _mm256_permute2x128_si256(a, b, 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32),
+        _mm256_permute2x128_si256(a, b, 0x31));
+    }
+
+    hex_ssse3(src, size, dst);
+  }
+
+  // Encodes 12 bytes into 16 base64 digits at the time, see
+  // http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+  __attribute__((target("ssse3")))
+  std::size_t base64_ssse3(const unsigned char* src, std::size_t size,
+      char* dst) {
+    const auto shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4,
+      1, 2, 0, 1);
+    const auto shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '+' - 62, '/' - 63, 'A', 0, 0);
+    auto p = dst;
+
+    // Loads 16 bytes, only 12 of which are used.
+    for (; size >= 16; src += 12, p += 16, size -= 12) {
+      auto in = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), shuffle);
+
+      // Split each group of three bytes into four 6 bit indices.
+      auto t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+      auto t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+      auto t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+      auto t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+      auto indices = _mm_or_si128(t1, t3);
+
+      // Map each index range to the offset of its digits.
+      auto r = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      auto less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      r = _mm_or_si128(r, _mm_and_si128(less, _mm_set1_epi8(13)));
+      r = _mm_add_epi8(_mm_shuffle_epi8(shift, r), indices);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), r);
+    }
+
+    return p - dst + base64_scalar(src, size, p);
+  }
+
+  using hex_kernel = void (*)(const unsigned char*, std::size_t, char*);
+  using base64_kernel = std::size_t (*)(const unsigned char*, std::size_t,
+    char*);
+
+  hex_kernel select_hex() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? hex_avx2
+      : __builtin_cpu_supports("ssse3") ? hex_ssse3
+      : hex_scalar;
+  }
+
+  base64_kernel select_base64() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") ? base64_ssse3 : base64_scalar;
+  }
+#endif
+}
+
+void logg::detail::encode_hex(const unsigned char* src, std::size_t size,
+    char* dst) noexcept {
+#ifdef LOGG_DETAIL_X86
+  static const auto kernel = select_hex();
+  kernel(src, size, dst);
+#else
+  hex_scalar(src, size, dst);
+#endif
+}
+
+std::size_t logg::detail::encode_base64(const unsigned char* src,
+    std::size_t size, char* dst) noexcept {
+#ifdef LOGG_DETAIL_X86
+  static const auto kernel = select_base64();
+  return kernel(src, size, dst);
+#else
+  return base64_scalar(src, size, dst);
+#endif
+}
@@ -0,0 +1,92 @@
+#include <string>
+#include <time.h>
+
+#include "logg/index.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Tells whether the index belongs to the log file of the specified size,
+  // i.e. the log file hasn't been rotated or truncated since the last entry
+  // was written.
+  bool is_current(const std::string& path, std::streamoff size) {
+    std::ifstream in(path, std::ios_base::binary | std::ios_base::ate);
+    std::streamoff end = in.tellg();
+    if (!in || end < std::streamoff(sizeof (index_entry))) {
+      return true;
+    }
+
+    index_entry entry;
+    in.seekg(end - end % sizeof (entry) - sizeof (entry));
+    in.read(reinterpret_cast<char*>(&entry), sizeof (entry));
+
+    return in && size > 0 && entry.offset <= std::uint64_t(size);
+  }
+}
+
+logg::index_filebuf::~index_filebuf() {
+  close();
+}
+
+logg::index_filebuf* logg::index_filebuf::open(const char* path,
+    unsigned interval) {
+  const auto mode = std::ios_base::out | std::ios_base::app;
+
+  if (!std::filebuf::open(path, mode)) {
+    return nullptr;
+  }
+
+  // Entries left by a rotated log file are stale, start over.
+  index_path = std::string(path) + index_suffix;
+  last = std::filebuf::seekoff(0, std::ios_base::end, std::ios_base::out);
+
+  if (!idx.open(index_path, is_current(index_path, last)
+      ? mode | std::ios_base::binary
+      : std::ios_base::out | std::ios_base::trunc | std::ios_base::binary)) {
+    std::filebuf::close();
+    return nullptr;
+  }
+
+  this->interval = interval;
+
+  return this;
+}
+
+logg::index_filebuf* logg::index_filebuf::close() {
+  auto log = std::filebuf::close();
+  auto index = idx.close();
+  return log && index ? this : nullptr;
+}
+
+int logg::index_filebuf::sync() {
+  if (std::filebuf::sync() != 0) {
+    return -1;
+  }
+
+  // Sync is called at the end of every log message, so the current offset
+  // is always the start of the next log message.
+  auto off = std::filebuf::seekoff(0, std::ios_base::cur, std::ios_base::out);
+  if (off < 0) {
+    return 0;
+  }
+
+  // The log file has been truncated, e.g. rotated by copying, start over.
+  if (off < last) {
+    last = 0;
+    idx.close();
+    if (!idx.open(index_path, std::ios_base::out | std::ios_base::trunc |
+        std::ios_base::binary)) {
+      return -1;
+    }
+  }
+
+  if (off - last < interval) {
+    return 0;
+  }
+
+  index_entry entry{time(nullptr), static_cast<std::uint64_t>(off)};
+  idx.sputn(reinterpret_cast<const char*>(&entry), sizeof (entry));
+  last = off;
+
+  return idx.pubsync();
+}
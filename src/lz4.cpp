@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include "logg/compress.h"
+
+using namespace logg::detail;
+
+namespace {
+  using byte = unsigned char;
+
+  // Hash table size used when searching for matches.
+  constexpr const int hash_log = 12;
+
+  // Shortest match, and the number of bytes at the end of a block which
+  // must be literals according to the LZ4 block format.
+  constexpr const std::size_t min_match = 4;
+  constexpr const std::size_t last_literals = 5;
+  constexpr const std::size_t mf_limit = 12;
+
+  std::uint32_t read32(const byte* p) {
+    std::uint32_t v;
+    memcpy(&v, p, sizeof (v));
+    return v;
+  }
+
+  unsigned hash(std::uint32_t v) {
+    return (v * 2654435761u) >> (32 - hash_log);
+  }
+
+  byte* write_length(byte* op, std::size_t len) {
+    for (; len >= 255; len -= 255) {
+      *op++ = 255;
+    }
+    *op++ = static_cast<byte>(len);
+    return op;
+  }
+
+  bool read_length(const byte*& ip, const byte* end, std::size_t& len) {
+    byte b;
+    do {
+      if (ip >= end) {
+        return false;
+      }
+      b = *ip++;
+      len += b;
+    } while (b == 255);
+    return true;
+  }
+
+  byte* write_sequence(byte* op, const byte* anchor, std::size_t lit) {
+    auto token = op++;
+    *token = static_cast<byte>((lit < 15 ? lit : 15) << 4);
+    if (lit >= 15) {
+      op = write_length(op, lit - 15);
+    }
+    memcpy(op, anchor, lit);
+    return op + lit;
+  }
+}
+
+std::size_t logg::detail::lz4_compress(const char* src, std::size_t size,
+    char* dst) noexcept {
+  auto base = reinterpret_cast<const byte*>(src);
+  auto end = base + size;
+  auto ip = base;
+  auto anchor = base;
+  auto op = reinterpret_cast<byte*>(dst);
+
+  if (size > mf_limit) {
+    std::uint32_t table[1 << hash_log] = {};
+    const auto limit = end - mf_limit;
+    const auto match_limit = end - last_literals;
+
+    while (ip < limit) {
+      auto v = read32(ip);
+      auto& slot = table[hash(v)];
+      auto ref = base + slot;
+      slot = static_cast<std::uint32_t>(ip - base);
+
+      if (ref >= ip || ip - ref > 0xffff || read32(ref) != v) {
+        // Skip faster through data that doesn't compress.
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      // Extend the match backwards and forwards.
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+
+      auto mp = ip + min_match;
+      for (auto rp = ref + min_match; mp < match_limit && *mp == *rp; rp++) {
+        mp++;
+      }
+
+      auto token = op;
+      op = write_sequence(op, anchor, ip - anchor);
+
+      auto off = ip - ref;
+      *op++ = static_cast<byte>(off);
+      *op++ = static_cast<byte>(off >> 8);
+
+      auto len = mp - ip - min_match;
+      *token |= len < 15 ? len : 15;
+      if (len >= 15) {
+        op = write_length(op, len - 15);
+      }
+
+      ip = anchor = mp;
+    }
+  }
+
+  op = write_sequence(op, anchor, end - anchor);
+  return op - reinterpret_cast<byte*>(dst);
+}
+
+bool logg::detail::lz4_decompress(const char* src, std::size_t size,
+    char* dst, std::size_t raw_size) noexcept {
+  auto ip = reinterpret_cast<const byte*>(src);
+  auto end = ip + size;
+  auto base = reinterpret_cast<byte*>(dst);
+  auto op = base;
+  auto out_end = base + raw_size;
+
+  while (ip < end) {
+    auto token = *ip++;
+
+    std::size_t lit = token >> 4;
+    if (lit == 15 && !read_length(ip, end, lit)) {
+      return false;
+    }
+
+    if (std::size_t(end - ip) < lit || std::size_t(out_end - op) < lit) {
+      return false;
+    }
+
+    memcpy(op, ip, lit);
+    op += lit;
+    ip += lit;
+
+    // The last sequence has literals only.
+    if (ip == end) {
+      break;
+    }
+
+    if (end - ip < 2) {
+      return false;
+    }
+
+    std::size_t off = ip[0] | ip[1] << 8;
+    ip += 2;
+
+    if (off == 0 || off > std::size_t(op - base)) {
+      return false;
+    }
+
+    std::size_t len = token & 15;
+    if (len == 15 && !read_length(ip, end, len)) {
+      return false;
+    }
+    len += min_match;
+
+    if (std::size_t(out_end - op) < len) {
+      return false;
+    }
+
+    // Byte by byte, the match may overlap the output.
+    for (auto mp = op - off; len > 0; len--) {
+      *op++ = *mp++;
+    }
+  }
+
+  return op == out_end;
+}
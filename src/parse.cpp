@@ -0,0 +1,86 @@
+#include <string.h>
+
+#include "logg/header.h"
+#include "logg/levels.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Names of the standard log levels as written to the log message header.
+  struct {
+    const char* name;
+    unsigned level;
+  } const names[] = {
+    {"FATAL", logg::FATAL},
+    {"ERROR", logg::ERROR},
+    {"WARN",  logg::WARN},
+    {"INFO",  logg::INFO},
+    {"DEBUG", logg::DEBUG},
+    {"TRACE", logg::TRACE}
+  };
+
+  bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+  }
+}
+
+unsigned logg::detail::parse_level(const char* buf, std::size_t size)
+    noexcept {
+  // Timestamp followed by the opening bracket of the thread id, where 'D'
+  // matches any decimal digit.
+  static const char pattern[] = "DDDD-DD-DD DD:DD:DD [";
+  const auto end = buf + size;
+
+  if (size < sizeof (pattern) - 1) {
+    return logg::OFF;
+  }
+
+  for (auto i = 0u; i < sizeof (pattern) - 1; i++) {
+    if (pattern[i] == 'D' ? !is_digit(buf[i]) : buf[i] != pattern[i]) {
+      return logg::OFF;
+    }
+  }
+
+  // Skip the thread id.
+  auto p = buf + sizeof (pattern) - 1;
+  while (p < end && is_digit(*p)) {
+    p++;
+  }
+
+  if (end - p < 2 || p[0] != ']' || p[1] != ' ') {
+    return logg::OFF;
+  }
+
+  p += 2;
+
+  // Skip the key=value pairs of the diagnostic context.
+  for (;;) {
+    auto sp = static_cast<const char*>(memchr(p, ' ', end - p));
+    if (!sp || !memchr(p, '=', sp - p)) {
+      break;
+    }
+    p = sp + 1;
+  }
+
+  for (const auto& n : names) {
+    auto len = strlen(n.name);
+    if (std::size_t(end - p) > len && memcmp(p, n.name, len) == 0 &&
+        p[len] == ' ') {
+      return n.level;
+    }
+  }
+
+  // Custom log levels are written as CUSTOM(level).
+  static const char custom[] = "CUSTOM(";
+  if (std::size_t(end - p) < sizeof (custom) ||
+      memcmp(p, custom, sizeof (custom) - 1) != 0) {
+    return logg::OFF;
+  }
+
+  unsigned level = 0;
+  for (p += sizeof (custom) - 1; p < end && is_digit(*p); p++) {
+    level = level * 10 + (*p - '0');
+  }
+
+  return p < end && *p == ')' ? level : logg::OFF;
+}
@@ -0,0 +1,268 @@
+#include <chrono>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "logg/datagram.h"
+#include "logg/header.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Sizes of the header and log message stored first in each slot.
+  struct slot_header {
+    std::uint32_t prefix;
+    std::uint32_t size;
+  };
+
+  // Offset of the log message in a slot.
+  constexpr const std::size_t payload_offset = sizeof (slot_header) +
+    datagram_prefix_size;
+
+  // Highest syslog facility, local7.
+  constexpr const unsigned max_facility = 23;
+
+  // Longest time a log message waits for its batch to be filled.
+  constexpr const std::int64_t max_delay = 100;
+
+  // Log messages sent per call to sendmmsg.
+  constexpr const unsigned max_batch = 64;
+
+  // Shortest time between attempts to reconnect to the agent.
+  constexpr const std::int64_t reconnect_interval = 1000;
+
+  // Times waited for the agent on close.
+  constexpr const int close_attempts = 10;
+  constexpr const int close_timeout = 10;
+
+  std::int64_t now() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(
+      steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Connects a new socket to the agent. Returns -1 on failure.
+  int connect_agent(const char* path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    auto fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return -1;
+    }
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof (addr)) != 0) {
+      ::close(fd);
+      return -1;
+    }
+
+    return fd;
+  }
+}
+
+logg::datagram_buf::~datagram_buf() {
+  close();
+}
+
+logg::datagram_buf* logg::datagram_buf::open(const char* path,
+    const char* app_name, unsigned facility, unsigned batch,
+    unsigned capacity) {
+  if (fd >= 0 || facility > max_facility || batch == 0 || capacity == 0 ||
+      strlen(path) >= sizeof (sockaddr_un::sun_path)) {
+    return nullptr;
+  }
+
+  fd = connect_agent(path);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  this->path = path;
+  reconnected = 0;
+
+  char host[256] = "-";
+  if (gethostname(host, sizeof (host)) != 0 || host[0] == '\0') {
+    strcpy(host, "-");
+  }
+  host[sizeof (host) - 1] = '\0';
+
+  // Timestamp is left out, the log message header already has one.
+  auto n = snprintf(fields, sizeof (fields), "1 - %.128s %.48s %d - - ",
+    host, app_name && *app_name ? app_name : "-", getpid());
+  fields_size = n < int(sizeof (fields)) ? n : sizeof (fields) - 1;
+
+  this->facility = facility;
+  this->batch = batch < max_batch ? batch : max_batch;
+  this->capacity = capacity;
+  slots.assign((capacity + 1) * datagram_slot_size, '\0');
+  first = 0;
+  count = 0;
+  lost = 0;
+
+  next();
+  return this;
+}
+
+logg::datagram_buf* logg::datagram_buf::close() {
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  // Give a slow agent a bounded amount of time to catch up.
+  for (auto i = 0; i < close_attempts && send() > 0; i++) {
+    pollfd p{fd, POLLOUT, 0};
+    poll(&p, 1, close_timeout);
+  }
+
+  auto ok = count == 0;
+  lost += count;
+  count = 0;
+
+  ::close(fd);
+  fd = -1;
+  setp(nullptr, nullptr);
+
+  return ok ? this : nullptr;
+}
+
+std::size_t logg::datagram_buf::send() {
+  if (fd < 0) {
+    return count;
+  }
+
+  mmsghdr msgs[max_batch];
+  iovec iov[max_batch];
+
+  while (count > 0) {
+    auto n = count < max_batch ? count : max_batch;
+
+    for (std::size_t i = 0; i < n; i++) {
+      auto s = slot(i);
+      slot_header h;
+      memcpy(&h, s, sizeof (h));
+
+      iov[i] = {s + payload_offset - h.prefix, h.prefix + h.size};
+      msgs[i] = {};
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    auto sent = sendmmsg(fd, msgs, n, MSG_DONTWAIT);
+
+    if (sent < 0) {
+      // The agent is busy, try again later.
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS ||
+          errno == EINTR) {
+        break;
+      }
+
+      // The agent has been restarted, the socket stays connected to the
+      // old one. Reconnect and retry the batch.
+      if ((errno == ECONNREFUSED || errno == ENOTCONN ||
+          errno == ECONNRESET || errno == EPIPE) && reconnect()) {
+        continue;
+      }
+
+      // The agent is gone or rejects the batch, drop it.
+      sent = n;
+      lost += n;
+    }
+
+    first = (first + sent) % (capacity + 1);
+    count -= sent;
+
+    if (std::size_t(sent) < n) {
+      break;
+    }
+  }
+
+  // Back off before retrying log messages left queued.
+  oldest = now();
+
+  return count;
+}
+
+logg::datagram_buf::int_type logg::datagram_buf::overflow(int_type c) {
+  // The log message doesn't fit in a slot, the remainder is discarded.
+  return fd >= 0 ? traits_type::not_eof(c) : traits_type::eof();
+}
+
+int logg::datagram_buf::sync() {
+  if (fd < 0) {
+    return -1;
+  }
+
+  auto msg = pbase();
+  std::size_t size = pptr() - pbase();
+
+  if (size > 0 && msg[size - 1] == '\n') {
+    size--;
+  }
+
+  if (size == 0) {
+    next();
+    return 0;
+  }
+
+  // Drop the log message if the agent can't keep up.
+  if (count == capacity && send() == capacity) {
+    lost++;
+    next();
+    return 0;
+  }
+
+  char pri[8];
+  auto n = snprintf(pri, sizeof (pri), "<%u>",
+    facility * 8 + severity(parse_level(msg, size)));
+
+  slot_header h{static_cast<std::uint32_t>(n + fields_size),
+    static_cast<std::uint32_t>(size)};
+  memcpy(msg - h.prefix, pri, n);
+  memcpy(msg - fields_size, fields, fields_size);
+  memcpy(slot(count), &h, sizeof (h));
+
+  if (count++ == 0) {
+    oldest = now();
+  }
+
+  next();
+
+  if (count % batch == 0 || now() - oldest >= max_delay) {
+    send();
+  }
+
+  return 0;
+}
+
+bool logg::datagram_buf::reconnect() {
+  // Rate limited, the agent may be gone for a while.
+  auto t = now();
+  if (t - reconnected < reconnect_interval) {
+    return false;
+  }
+
+  reconnected = t;
+
+  auto s = connect_agent(path.c_str());
+  if (s < 0) {
+    return false;
+  }
+
+  ::close(fd);
+  fd = s;
+  return true;
+}
+
+char* logg::datagram_buf::slot(std::size_t index) noexcept {
+  return slots.data() + (first + index) % (capacity + 1) * datagram_slot_size;
+}
+
+void logg::datagram_buf::next() {
+  auto s = slot(count);
+  setp(s + payload_offset, s + datagram_slot_size);
+}
@@ -7,17 +7,16 @@
 #if defined(__linux__)
 #include <sys/syscall.h>
 #include <sys/types.h>
-namespace {
-  unsigned thread_id() {
-    return syscall(SYS_gettid);
-  }
-}
 #else
 #error Unsupported POSIX system
 #endif
 
 using namespace logg::detail;
 
+unsigned logg::detail::thread_id() noexcept {
+  return syscall(SYS_gettid);
+}
+
 const char fatal[] = "FATAL";
 
 unsigned logg::detail::build_header(char* buf, unsigned size) {
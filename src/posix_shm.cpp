@@ -0,0 +1,384 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logg/shm.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Log messages written to the log stream before it's flushed and their
+  // slots are released.
+  constexpr const std::size_t drain_batch = 64;
+
+  std::size_t segment_size(std::uint32_t capacity) {
+    return sizeof (shm_ring) + std::size_t(capacity) * sizeof (shm_slot);
+  }
+
+#ifdef F_OFD_SETLK
+  // Writers hold a lock on the byte of the segment matching their writer
+  // id. Open file description locks are released by the kernel when the
+  // writer dies, and work regardless of pid namespaces.
+  bool lock_writer(int fd, std::size_t id) {
+    struct flock fl{};
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = id;
+    fl.l_len = 1;
+    return fcntl(fd, F_OFD_SETLK, &fl) == 0;
+  }
+
+  bool is_alive(int fd, std::size_t id) {
+    struct flock fl{};
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = id;
+    fl.l_len = 1;
+    return fcntl(fd, F_OFD_GETLK, &fl) != 0 || fl.l_type != F_UNLCK;
+  }
+#else
+  // Without open file description locks writers can't be told apart, all
+  // writers are considered alive and slots are never recycled.
+  bool lock_writer(int, std::size_t) {
+    return true;
+  }
+
+  bool is_alive(int, std::size_t) {
+    return true;
+  }
+#endif
+}
+
+shm_ring* logg::detail::map_ring(int fd, std::uint32_t capacity,
+    bool create, std::size_t& size) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return nullptr;
+  }
+
+  // Writers take the capacity from the ring, which is only valid once the
+  // collector has stored the magic.
+  size = st.st_size;
+  if (size < sizeof (shm_ring) && !create) {
+    return nullptr;
+  }
+
+  auto p = size > 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+    fd, 0) : MAP_FAILED;
+  if (size > 0 && p == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // A segment holding a valid ring may be mapped by live writers and is
+  // never resized or reinitialized. Anything else isn't in use by writers
+  // and is (re)created by the collector.
+  auto valid = size >= sizeof (shm_ring) &&
+    static_cast<shm_ring*>(p)->magic.load(std::memory_order_acquire) ==
+      shm_magic;
+
+  if (!valid) {
+    if (size > 0) {
+      munmap(p, size);
+    }
+
+    if (!create) {
+      return nullptr;
+    }
+
+    size = segment_size(capacity);
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0) {
+      return nullptr;
+    }
+
+    p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+      return nullptr;
+    }
+  }
+
+  auto ring = static_cast<shm_ring*>(p);
+
+  if (!valid) {
+    ring->capacity = capacity;
+    for (std::uint32_t i = 0; i < capacity; i++) {
+      slots(ring)[i].seq.store(i, std::memory_order_relaxed);
+    }
+    ring->magic.store(shm_magic, std::memory_order_release);
+  }
+
+  // An existing ring is only attached to as is.
+  auto n = ring->capacity;
+  if (segment_size(n) != size || n == 0 || (n & (n - 1)) != 0 ||
+      (create && n != capacity)) {
+    munmap(p, size);
+    errno = EINVAL;
+    return nullptr;
+  }
+
+  return ring;
+}
+
+void logg::detail::unmap_ring(shm_ring* ring, std::size_t size) {
+  munmap(ring, size);
+}
+
+logg::shm_buf::~shm_buf() {
+  close();
+}
+
+logg::shm_buf* logg::shm_buf::open(const char* name) {
+  if (ring) {
+    return nullptr;
+  }
+
+  this->name = name;
+  if (!attach()) {
+    close();
+    return nullptr;
+  }
+
+  setp(buf, buf + sizeof (buf));
+  return this;
+}
+
+void logg::shm_buf::close() {
+  if (ring) {
+    unmap_ring(ring, mapped);
+    ring = nullptr;
+  }
+
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+
+  setp(nullptr, nullptr);
+}
+
+bool logg::shm_buf::attach() {
+  // A forked child shares the lock of its parent, it takes a writer id of
+  // its own using a new open file description.
+  if (fd >= 0) {
+    ::close(fd);
+  }
+
+  pid = getpid();
+  fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return false;
+  }
+
+  if (!ring) {
+    ring = map_ring(fd, 0, false, mapped);
+    if (!ring) {
+      return false;
+    }
+  }
+
+  for (id = 0; id < shm_max_writers; id++) {
+    if (lock_writer(fd, id)) {
+      ring->claims[id].store(0, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+logg::shm_buf::int_type logg::shm_buf::overflow(int_type c) {
+  // The log message doesn't fit in a slot, the remainder is discarded.
+  return ring ? traits_type::not_eof(c) : traits_type::eof();
+}
+
+int logg::shm_buf::sync() {
+  if (!ring) {
+    return -1;
+  }
+
+  std::size_t size = pptr() - pbase();
+  if (size == 0) {
+    return 0;
+  }
+
+  setp(buf, buf + sizeof (buf));
+
+  if (getpid() != pid && !attach()) {
+    close();
+    return -1;
+  }
+
+  // The ring never changes size while mapped, but the segment is shared
+  // with other processes, never index past the mapping.
+  const auto capacity = ring->capacity;
+  if (segment_size(capacity) != mapped) {
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+
+  // Claim the slot at the head of the ring.
+  // The claim is published before the head moves, so that the collector
+  // can tell who owns a claimed slot.
+  const auto mask = capacity - 1;
+  auto& claim = ring->claims[id];
+  auto pos = ring->head.load(std::memory_order_relaxed);
+  shm_slot* slot;
+
+  for (;;) {
+    slot = &slots(ring)[pos & mask];
+    auto seq = slot->seq.load(std::memory_order_acquire);
+    auto diff = static_cast<std::int64_t>(seq - pos);
+
+    if (diff == 0) {
+      claim.store(pos + 1);
+      if (ring->head.compare_exchange_weak(pos, pos + 1)) {
+        break;
+      }
+    } else if (diff < 0) {
+      claim.store(0, std::memory_order_release);
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return 0;
+    } else {
+      pos = ring->head.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->size = static_cast<std::uint32_t>(size);
+  memcpy(slot->data, buf, size);
+
+  // Slots are only recycled once their writer is gone, committing never
+  // fails while alive.
+  slot->seq.store(pos + 1, std::memory_order_release);
+  claim.store(0, std::memory_order_release);
+
+  return 0;
+}
+
+logg::shm_collector::~shm_collector() {
+  close();
+}
+
+logg::shm_collector* logg::shm_collector::open(const char* name,
+    std::uint32_t capacity) {
+  if (ring || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    return nullptr;
+  }
+
+  // The descriptor is kept to query the locks of the writers.
+  fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  ring = map_ring(fd, capacity, true, mapped);
+  if (!ring) {
+    close();
+    return nullptr;
+  }
+
+  return this;
+}
+
+void logg::shm_collector::close() {
+  if (ring) {
+    unmap_ring(ring, mapped);
+    ring = nullptr;
+  }
+
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+bool logg::shm_collector::is_owned(std::uint64_t pos) const {
+  for (std::size_t id = 0; id < shm_max_writers; id++) {
+    if (ring->claims[id].load() == pos + 1 && is_alive(fd, id)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::size_t logg::shm_collector::drain(std::ostream& os) {
+  if (!ring) {
+    return 0;
+  }
+
+  const auto capacity = ring->capacity;
+  const auto mask = capacity - 1;
+  auto tail = ring->tail.load(std::memory_order_relaxed);
+  std::size_t count = 0;
+  std::size_t written = 0;
+
+  // Slots written to the log stream are released once flushed, so that
+  // log messages taken from the ring survive a crashing collector.
+  auto release = [&] {
+    if (written == 0) {
+      return true;
+    }
+
+    if (!os.flush()) {
+      return false;
+    }
+
+    for (; written > 0; written--, tail++) {
+      slots(ring)[tail & mask].seq.store(tail + capacity,
+        std::memory_order_release);
+    }
+
+    ring->tail.store(tail, std::memory_order_relaxed);
+    return true;
+  };
+
+  for (;;) {
+    auto pos = tail + written;
+    auto& slot = slots(ring)[pos & mask];
+    auto seq = slot.seq.load(std::memory_order_acquire);
+
+    if (seq == pos + 1) {
+      auto size = slot.size < sizeof (slot.data) ? slot.size
+        : sizeof (slot.data);
+      os.write(slot.data, size);
+
+      // Truncated log messages lack the line break.
+      if (size == 0 || slot.data[size - 1] != '\n') {
+        os.put('\n');
+      }
+
+      count++;
+      if (++written == drain_batch && !release()) {
+        return count;
+      }
+    } else if (ring->head.load(std::memory_order_acquire) == pos) {
+      // Empty.
+      break;
+    } else {
+      // Claimed but not yet committed. Skip the slot if its writer is
+      // gone, otherwise wait for it, however long it takes. Recycling the
+      // slot of a live writer would let it overwrite the next log message.
+      if (is_owned(pos) || !release()) {
+        break;
+      }
+
+      if (!slot.seq.compare_exchange_strong(seq, pos + capacity,
+          std::memory_order_acq_rel)) {
+        // Committed after all.
+        continue;
+      }
+
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      ring->tail.store(++tail, std::memory_order_relaxed);
+    }
+  }
+
+  release();
+  return count;
+}
+
+std::uint64_t logg::shm_collector::dropped() const noexcept {
+  return ring ? ring->dropped.load(std::memory_order_relaxed) : 0;
+}
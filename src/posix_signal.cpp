@@ -0,0 +1,86 @@
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logg/header.h"
+#include "logg/signal.h"
+
+using namespace logg::detail;
+
+namespace {
+  long local_utc_offset() {
+    tm tmp;
+    auto now = time(nullptr);
+    return localtime_r(&now, &tmp) ? tmp.tm_gmtoff : 0;
+  }
+
+  // Converts days since the epoch to a civil date, see
+  // http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+  void civil_from_days(long long z, long long& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    auto era = (z >= 0 ? z : z - 146096) / 146097;
+    auto doe = static_cast<unsigned>(z - era * 146097);
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<long long>(yoe) + era * 400 + (m <= 2);
+  }
+}
+
+logg::signal_safe::signal_safe(int fd)
+    : fd(fd), utc_offset(local_utc_offset()) {}
+
+void signal_writer::write_header(long utc_offset) noexcept {
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+
+  auto t = static_cast<long long>(ts.tv_sec) + utc_offset;
+  auto days = (t >= 0 ? t : t - 86399) / 86400;
+  auto secs = static_cast<unsigned long long>(t - days * 86400);
+
+  long long y;
+  unsigned m, d;
+  civil_from_days(days, y, m, d);
+
+  // Same format as build_header, i.e. "%F %T [tid]".
+  append(y);
+  append('-');
+  append(m, 10, 2);
+  append('-');
+  append(d, 10, 2);
+  append(' ');
+  append(secs / 3600, 10, 2);
+  append(':');
+  append(secs / 60 % 60, 10, 2);
+  append(':');
+  append(secs % 60, 10, 2);
+  append(" [");
+  append(static_cast<unsigned long long>(thread_id()));
+  append(']');
+}
+
+void signal_writer::write(int fd) noexcept {
+  // Make room for the line break in a full buffer.
+  if (size == sizeof (buf)) {
+    size--;
+  }
+  append('\n');
+
+  // Signal handlers must leave errno untouched.
+  auto saved = errno;
+
+  for (unsigned off = 0; off < size;) {
+    auto n = ::write(fd, buf + off, size - off);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    off += n;
+  }
+
+  errno = saved;
+}
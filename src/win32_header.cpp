@@ -6,10 +6,8 @@
 
 using namespace logg::detail;
 
-namespace {
-  unsigned thread_id() {
-    return GetCurrentThreadId();
-  }
+unsigned logg::detail::thread_id() noexcept {
+  return GetCurrentThreadId();
 }
 
 unsigned logg::detail::build_header(char* buf, unsigned size) {
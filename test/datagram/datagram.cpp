@@ -0,0 +1,271 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+/*
+ * Tests logg::datagram_buf against a local agent stand-in, receiving
+ * datagrams on a Unix socket. Exits with a non-zero status on failure.
+ *
+ * All log levels are enabled, regardless of the configured log level.
+ */
+
+#undef LOGG_LOG_LEVEL
+#define LOGG_LOG_LEVEL logg::ALL
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "logg/datagram.h"
+#include "logg/logg.h"
+
+namespace {
+  int failures = 0;
+
+  void check(bool ok, const std::string& what) {
+    if (!ok) {
+      std::cerr << "FAILED: " << what << std::endl;
+      failures++;
+    }
+  }
+
+  // Local agent stand-in.
+  struct agent {
+    agent() {
+      if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        std::exit(1);
+      }
+
+      addr.sun_family = AF_UNIX;
+      std::snprintf(addr.sun_path, sizeof (addr.sun_path), "%s/agent", dir);
+      bind();
+    }
+
+    ~agent() {
+      close(fd);
+      unlink(addr.sun_path);
+      rmdir(dir);
+    }
+
+    // Binds a new socket to the path, e.g. when restarted.
+    void bind() {
+      if (fd >= 0) {
+        close(fd);
+        unlink(addr.sun_path);
+      }
+
+      fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+      if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr),
+          sizeof (addr)) != 0) {
+        std::perror(addr.sun_path);
+        std::exit(1);
+      }
+    }
+
+    // Receives the datagrams, waiting for the first one at most the
+    // specified number of milliseconds.
+    std::vector<std::string> receive(int timeout = 1000) {
+      std::vector<std::string> received;
+      char buf[4096];
+
+      pollfd p{fd, POLLIN, 0};
+      if (poll(&p, 1, timeout) <= 0) {
+        return received;
+      }
+
+      for (;;) {
+        auto n = recv(fd, buf, sizeof (buf), MSG_DONTWAIT);
+        if (n < 0) {
+          return received;
+        }
+        received.emplace_back(buf, n);
+      }
+    }
+
+    char dir[32] = "/tmp/logg-XXXXXX";
+    int fd = -1;
+    sockaddr_un addr{};
+  };
+
+  // Header fields following the priority, as framed by datagram_buf.
+  std::string fields(const char* app) {
+    char host[256] = "-";
+    if (gethostname(host, sizeof (host)) != 0 || host[0] == '\0') {
+      std::strcpy(host, "-");
+    }
+    host[sizeof (host) - 1] = '\0';
+
+    return "1 - " + std::string(host).substr(0, 128) + " " + app + " " +
+      std::to_string(getpid()) + " - - ";
+  }
+
+  // Checks the framing of a single log message.
+  template<class Log>
+  void check_framing(agent& a, std::ostream& log, Log write, unsigned pri,
+      const std::string& level) {
+    write(log);
+
+    auto received = a.receive();
+    check(received.size() == 1, level + ": one datagram");
+    if (received.empty()) {
+      return;
+    }
+
+    const auto& msg = received.front();
+    auto prefix = "<" + std::to_string(pri) + ">" + fields("test");
+    check(msg.compare(0, prefix.size(), prefix) == 0,
+      level + ": prefix of '" + msg + "'");
+
+    std::regex header(
+      "\\d{4}-\\d\\d-\\d\\d \\d\\d:\\d\\d:\\d\\d \\[\\d+\\] " + level +
+      " - Hello, world!");
+    check(msg.size() >= prefix.size() &&
+      std::regex_match(msg.substr(prefix.size()), header),
+      level + ": message of '" + msg + "'");
+  }
+
+  void test_framing(agent& a) {
+    logg::datagram_buf buf;
+    if (!buf.open(a.addr.sun_path, "test", 16, 1)) {
+      check(false, "framing: open");
+      return;
+    }
+
+    std::ostream log(&buf);
+
+    // Facility local0, i.e. 16, priority is facility * 8 + severity.
+    check_framing(a, log, [](std::ostream& log) {
+      logg::fatal(log) << "Hello, world!";
+    }, 130, "FATAL");
+    check_framing(a, log, [](std::ostream& log) {
+      logg::error(log) << "Hello, world!";
+    }, 131, "ERROR");
+    check_framing(a, log, [](std::ostream& log) {
+      logg::warn(log) << "Hello, world!";
+    }, 132, "WARN");
+    check_framing(a, log, [](std::ostream& log) {
+      logg::info(log) << "Hello, world!";
+    }, 134, "INFO");
+    check_framing(a, log, [](std::ostream& log) {
+      logg::debug(log) << "Hello, world!";
+    }, 135, "DEBUG");
+    check_framing(a, log, [](std::ostream& log) {
+      logg::trace(log) << "Hello, world!";
+    }, 135, "TRACE");
+    check_framing(a, log, [](std::ostream& log) {
+      logg::log<250>(log) << "Hello, world!";
+    }, 132, "CUSTOM\\(250\\)");
+
+    // Lines without a log message header are informational.
+    log << "Hello, world!" << std::endl;
+    auto received = a.receive();
+    check(received.size() == 1 &&
+      received.front() == "<134>" + fields("test") + "Hello, world!",
+      "no header");
+
+    check(buf.close() == &buf && buf.dropped() == 0, "framing: close");
+  }
+
+  void test_facility(agent& a) {
+    logg::datagram_buf buf;
+    check(buf.open(a.addr.sun_path, "test", 23), "facility 23");
+    buf.close();
+    check(!buf.open(a.addr.sun_path, "test", 24), "facility 24 rejected");
+  }
+
+  void test_batching(agent& a) {
+    logg::datagram_buf buf;
+    if (!buf.open(a.addr.sun_path, "test", 1, 4)) {
+      check(false, "batching: open");
+      return;
+    }
+
+    std::ostream log(&buf);
+
+    for (auto i = 0; i < 3; i++) {
+      logg::info(log) << "i=" << i;
+    }
+    check(a.receive(0).empty(), "batching: queued until filled");
+
+    logg::info(log) << "i=" << 3;
+    auto received = a.receive();
+    check(received.size() == 4, "batching: sent when filled");
+
+    for (std::size_t i = 0; i < received.size(); i++) {
+      auto suffix = " - i=" + std::to_string(i);
+      const auto& msg = received[i];
+      check(msg.size() >= suffix.size() &&
+        msg.compare(msg.size() - suffix.size(), suffix.size(), suffix) == 0,
+        "batching: order of '" + msg + "'");
+    }
+
+    // Sent on close, although the batch isn't filled.
+    logg::info(log) << "i=" << 4;
+    check(buf.close() == &buf, "batching: close");
+    check(a.receive().size() == 1, "batching: sent on close");
+  }
+
+  void test_dropped(agent& a) {
+    const auto total = 1000;
+
+    logg::datagram_buf buf;
+    if (!buf.open(a.addr.sun_path, "test", 1, 4, 8)) {
+      check(false, "dropped: open");
+      return;
+    }
+
+    // The agent doesn't read until done, the queue fills up.
+    std::ostream log(&buf);
+    for (auto i = 0; i < total; i++) {
+      logg::trace(log) << "i=" << i;
+    }
+
+    buf.close();
+
+    std::size_t received = 0;
+    for (auto r = a.receive(); !r.empty(); r = a.receive(0)) {
+      received += r.size();
+    }
+
+    check(buf.dropped() > 0, "dropped: some dropped");
+    check(received > 0, "dropped: some received");
+    check(received + buf.dropped() == total, "dropped: " +
+      std::to_string(received) + " received + " +
+      std::to_string(buf.dropped()) + " dropped");
+  }
+
+  void test_reconnect(agent& a) {
+    logg::datagram_buf buf;
+    if (!buf.open(a.addr.sun_path, "test", 1, 1)) {
+      check(false, "reconnect: open");
+      return;
+    }
+
+    std::ostream log(&buf);
+    logg::info(log) << "before";
+    check(a.receive().size() == 1, "reconnect: before restart");
+
+    a.bind();
+    logg::info(log) << "after";
+    check(a.receive().size() == 1, "reconnect: after restart");
+    check(buf.dropped() == 0, "reconnect: none dropped");
+  }
+}
+
+int main() {
+  agent a;
+
+  test_framing(a);
+  test_facility(a);
+  test_batching(a);
+  test_dropped(a);
+  test_reconnect(a);
+
+  return failures == 0 ? 0 : 1;
+}
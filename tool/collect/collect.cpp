@@ -0,0 +1,83 @@
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+/*
+ * Collects log messages written by any number of processes to a shared
+ * memory ring using logg::shm_buf, and appends them to a log file, or writes
+ * them to standard output if no file is given. Runs until interrupted.
+ *
+ * $ collect [-c CAPACITY] NAME [FILE]
+ */
+
+#include <unistd.h>
+
+#include "logg/shm.h"
+
+namespace {
+  volatile std::sig_atomic_t running = 1;
+
+  void stop(int) {
+    running = 0;
+  }
+
+  int usage() {
+    std::fprintf(stderr, "usage: collect [-c CAPACITY] NAME [FILE]\n");
+    return 2;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::uint32_t capacity = 4096;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "c:")) != -1) {
+    if (opt != 'c') {
+      return usage();
+    }
+    capacity = std::strtoul(optarg, nullptr, 10);
+  }
+
+  if (argc - optind < 1 || argc - optind > 2) {
+    return usage();
+  }
+
+  logg::shm_collector collector;
+  if (!collector.open(argv[optind], capacity)) {
+    std::perror(argv[optind]);
+    return 1;
+  }
+
+  std::ofstream file;
+  if (argc - optind == 2) {
+    file.open(argv[optind + 1], std::ios_base::app);
+    if (!file) {
+      std::perror(argv[optind + 1]);
+      return 1;
+    }
+  }
+
+  std::ostream& os = file.is_open() ? file : std::cout;
+
+  std::signal(SIGINT, stop);
+  std::signal(SIGTERM, stop);
+
+  // Drain until interrupted, backing off while the ring is empty. The log
+  // file is flushed by the collector before log messages leave the ring.
+  while (running) {
+    if (collector.drain(os) == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  collector.drain(os);
+
+  if (collector.dropped() > 0) {
+    std::fprintf(stderr, "%llu log messages dropped\n",
+      static_cast<unsigned long long>(collector.dropped()));
+  }
+}
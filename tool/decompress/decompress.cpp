@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <vector>
+
+/*
+ * Decompresses log files written using logg::compress_buf and writes the
+ * log messages to standard output. Reads standard input if no files are
+ * given.
+ *
+ * $ decompress [FILE]...
+ */
+
+#include "logg/compress.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Decompresses all blocks of a file. Returns false on a read error or a
+  // corrupt block.
+  bool decompress(std::FILE* in, const char* name) {
+    std::vector<char> data;
+    std::vector<char> raw;
+    block_header header;
+
+    while (std::fread(&header, sizeof (header), 1, in) == 1) {
+      if (header.magic != block_magic || header.raw_size > max_block_size ||
+          header.size > lz4_bound(max_block_size)) {
+        std::fprintf(stderr, "%s: invalid block header\n", name);
+        return false;
+      }
+
+      data.resize(header.size);
+      raw.resize(header.raw_size);
+
+      if (std::fread(data.data(), 1, data.size(), in) != data.size()) {
+        std::fprintf(stderr, "%s: truncated block\n", name);
+        return false;
+      }
+
+      if (!decode_block(header, data.data(), raw.data())) {
+        std::fprintf(stderr, "%s: corrupt block\n", name);
+        return false;
+      }
+
+      std::fwrite(raw.data(), 1, raw.size(), stdout);
+    }
+
+    if (std::ferror(in)) {
+      std::perror(name);
+      return false;
+    }
+
+    return true;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    return decompress(stdin, "stdin") ? 0 : 1;
+  }
+
+  auto status = 0;
+
+  for (auto i = 1; i < argc; i++) {
+    auto in = std::fopen(argv[i], "rb");
+    if (!in) {
+      std::perror(argv[i]);
+      status = 1;
+      continue;
+    }
+
+    if (!decompress(in, argv[i])) {
+      status = 1;
+    }
+
+    std::fclose(in);
+  }
+
+  return status;
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Extracts the log messages within a time range from a log file written using
+ * logg::index_filebuf. The sidecar index is binary searched for the offset to
+ * start from, and the log file is scanned from there until the end of the
+ * time range, making the extraction time scale with the size of the result
+ * rather than the size of the log file.
+ *
+ * $ extract [-l LEVEL] FILE FROM [TO]
+ *
+ * FROM and TO are local time on the form "YYYY-MM-DD HH:MM:SS", trailing
+ * fields may be left out, e.g. "2018-04-16 12:58" covers the whole minute.
+ */
+
+#include "logg/header.h"
+#include "logg/index.h"
+#include "logg/levels.h"
+
+using namespace logg::detail;
+
+namespace {
+  // Read-only memory mapping of an entire file.
+  struct mapping {
+    explicit mapping(const char* path) {
+      auto fd = open(path, O_RDONLY);
+      if (fd < 0) {
+        return;
+      }
+
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        auto p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+          data = static_cast<const char*>(p);
+          size = st.st_size;
+        }
+      }
+
+      close(fd);
+    }
+
+    ~mapping() {
+      if (data) {
+        munmap(const_cast<char*>(data), size);
+      }
+    }
+
+    const char* data = nullptr;
+    std::size_t size = 0;
+  };
+
+  // Completes a partial timestamp using the fields of the specified template.
+  std::string complete(const char* partial, const char* tmpl) {
+    std::string s(partial);
+    if (s.size() < timestamp_size) {
+      s.append(tmpl + s.size(), timestamp_size - s.size());
+    }
+    return s.substr(0, timestamp_size);
+  }
+
+  // Converts a timestamp to seconds since the epoch, local time.
+  time_t to_time(const std::string& ts) {
+    tm tmp{};
+    if (!strptime(ts.c_str(), "%F %T", &tmp)) {
+      return -1;
+    }
+    tmp.tm_isdst = -1;
+    return mktime(&tmp);
+  }
+
+  // Parses a log level name or number. Returns false if neither.
+  bool to_level(const char* s, unsigned& level) {
+    struct {
+      const char* name;
+      unsigned level;
+    } const names[] = {
+      {"OFF",   logg::OFF},
+      {"FATAL", logg::FATAL},
+      {"ERROR", logg::ERROR},
+      {"WARN",  logg::WARN},
+      {"INFO",  logg::INFO},
+      {"DEBUG", logg::DEBUG},
+      {"TRACE", logg::TRACE},
+      {"ALL",   logg::ALL}
+    };
+
+    for (const auto& n : names) {
+      if (strcmp(s, n.name) == 0) {
+        level = n.level;
+        return true;
+      }
+    }
+
+    char* end;
+    errno = 0;
+    auto n = strtoul(s, &end, 10);
+    if (end == s || *end != '\0' || errno != 0 || *s == '-' ||
+        n > std::numeric_limits<unsigned>::max()) {
+      return false;
+    }
+
+    level = static_cast<unsigned>(n);
+    return true;
+  }
+
+  // Finds the offset of the last index entry written before the specified
+  // time. Every log message before that offset is older than the time.
+  std::size_t find_offset(const char* file, time_t from, std::size_t size) {
+    mapping idx((std::string(file) + index_suffix).c_str());
+    if (!idx.data || from < 0) {
+      return 0;
+    }
+
+    auto first = reinterpret_cast<const index_entry*>(idx.data);
+    auto last = first + idx.size / sizeof (index_entry);
+
+    // Offsets start over when the log file is rotated or truncated, only
+    // entries written since then belong to the log file.
+    for (auto p = last; p - first > 1; p--) {
+      if ((p - 1)->offset < (p - 2)->offset) {
+        first = p - 1;
+        break;
+      }
+    }
+
+    auto it = std::lower_bound(first, last, from,
+      [](const index_entry& e, time_t t) { return e.time < t; });
+
+    // Entries past the end of the log file are stale as well.
+    while (it != first && (it - 1)->offset > size) {
+      it--;
+    }
+
+    return it == first ? 0 : (it - 1)->offset;
+  }
+
+  int usage() {
+    fprintf(stderr, "usage: extract [-l LEVEL] FILE FROM [TO]\n");
+    return 2;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  unsigned max_level = logg::ALL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "l:")) != -1) {
+    if (opt != 'l') {
+      return usage();
+    }
+    if (!to_level(optarg, max_level)) {
+      return usage();
+    }
+  }
+
+  if (argc - optind < 2 || argc - optind > 3) {
+    return usage();
+  }
+
+  auto file = argv[optind];
+  auto from = complete(argv[optind + 1], "0000-01-01 00:00:00");
+  auto to = complete(argc - optind == 3 ? argv[optind + 2] : "",
+    "9999-12-31 23:59:59");
+
+  mapping log(file);
+  if (!log.data) {
+    perror(file);
+    return 1;
+  }
+
+  auto off = find_offset(file, to_time(from), log.size);
+  auto end = log.data + log.size;
+
+  // Scan one line at the time. Lines not starting with a log message header
+  // belong to the previous log message and share its fate. Consecutive
+  // matching lines are written using a single call.
+  auto p = log.data + off;
+  auto run = end;
+  auto keep = false;
+
+  while (p < end) {
+    auto eol = static_cast<const char*>(memchr(p, '\n', end - p));
+    auto next = eol ? eol + 1 : end;
+    auto level = parse_level(p, next - p);
+
+    if (level != logg::OFF) {
+      if (to.compare(0, timestamp_size, p, timestamp_size) < 0) {
+        break;
+      }
+      keep = level <= max_level &&
+        from.compare(0, timestamp_size, p, timestamp_size) <= 0;
+    }
+
+    if (keep && run == end) {
+      run = p;
+    } else if (!keep && run != end) {
+      fwrite(run, 1, p - run, stdout);
+      run = end;
+    }
+
+    p = next;
+  }
+
+  if (run != end) {
+    fwrite(run, 1, p - run, stdout);
+  }
+}